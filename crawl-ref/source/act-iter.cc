@@ -8,20 +8,20 @@
 actor_near_iterator::actor_near_iterator(coord_def c, los_type los)
     : center(c), _los(los), viewer(nullptr), i(-1)
 {
-    if (!valid(&you))
+    if (!valid())
         advance();
 }
 
 actor_near_iterator::actor_near_iterator(const actor* a, los_type los)
     : center(a->pos()), _los(los), viewer(a), i(-1)
 {
-    if (!valid(&you))
+    if (!valid())
         advance();
 }
 
 actor_near_iterator::operator bool() const
 {
-    return valid(**this);
+    return valid();
 }
 
 actor* actor_near_iterator::operator*() const
@@ -52,21 +52,33 @@ actor_near_iterator actor_near_iterator::operator++(int)
     return copy;
 }
 
-bool actor_near_iterator::valid(const actor* a) const
+// The position of the actor in slot i (-1 for the player). Monster positions
+// come from env.mons_pos, so most monsters can be skipped as out of view
+// without touching them.
+static coord_def _slot_pos(int i)
 {
-    if (!a || !a->alive())
-        return false;
-    if (viewer && !a->visible_to(viewer))
+    if (i == -1)
+        return you.pos();
+#ifdef DEBUG
+    ASSERT(env.mons_pos[i] == env.mons[i].pos());
+#endif
+    return env.mons_pos[i];
+}
+
+bool actor_near_iterator::valid() const
+{
+    if (i >= MAX_MONSTERS || !cell_see_cell(center, _slot_pos(i), _los))
         return false;
-    return cell_see_cell(center, a->pos(), _los);
+    const actor* a = **this;
+    return a->alive() && (!viewer || a->visible_to(viewer));
 }
 
 void actor_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = env.mons_in_use.next(i + 1)) >= MAX_MONSTERS)
              return;
-    while (!valid(**this));
+    while (!valid());
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -74,7 +86,7 @@ void actor_near_iterator::advance()
 monster_near_iterator::monster_near_iterator(coord_def c, los_type los)
     : center(c), _los(los), viewer(nullptr), i(0)
 {
-    if (!valid(&env.mons[0]))
+    if (!valid())
         advance();
     begin_point = i;
 }
@@ -82,14 +94,14 @@ monster_near_iterator::monster_near_iterator(coord_def c, los_type los)
 monster_near_iterator::monster_near_iterator(const actor *a, los_type los)
     : center(a->pos()), _los(los), viewer(a), i(0)
 {
-    if (!valid(&env.mons[0]))
+    if (!valid())
         advance();
     begin_point = i;
 }
 
 monster_near_iterator::operator bool() const
 {
-    return valid(**this);
+    return valid();
 }
 
 monster* monster_near_iterator::operator*() const
@@ -142,30 +154,29 @@ monster_near_iterator monster_near_iterator::end()
     return copy;
 }
 
-bool monster_near_iterator::valid(const monster* a) const
+bool monster_near_iterator::valid() const
 {
-    if (!a || !a->alive())
-        return false;
-    if (viewer && !a->visible_to(viewer))
+    if (i >= MAX_MONSTERS || !cell_see_cell(center, _slot_pos(i), _los))
         return false;
-    return cell_see_cell(center, a->pos(), _los);
+    const monster* mon = **this;
+    return mon->alive() && (!viewer || mon->visible_to(viewer));
 }
 
 void monster_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = env.mons_in_use.next(i + 1)) >= MAX_MONSTERS)
              return;
-    while (!valid(**this));
+    while (!valid());
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 monster_iterator::monster_iterator()
-    : i(0)
+    : i(env.mons_in_use.next(0))
 {
     while (i < MAX_MONSTERS && !env.mons[i].alive())
-        i++;
+        i = env.mons_in_use.next(i + 1);
 }
 
 monster_iterator::operator bool() const
@@ -188,7 +199,7 @@ monster* monster_iterator::operator->() const
 
 monster_iterator& monster_iterator::operator++()
 {
-    while (++i < MAX_MONSTERS)
+    while ((i = env.mons_in_use.next(i + 1)) < MAX_MONSTERS)
         if (env.mons[i].alive())
             break;
     return *this;
@@ -204,7 +215,7 @@ monster_iterator monster_iterator::operator++(int)
 void monster_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = env.mons_in_use.next(i + 1)) >= MAX_MONSTERS)
              return;
     while (!(*this)->alive());
 }
@@ -25,7 +25,7 @@ protected:
     const actor* viewer;
     int i;
 
-    bool valid(const actor* a) const;
+    bool valid() const;
     void advance();
 };
 
@@ -52,7 +52,7 @@ protected:
     int i;
     int begin_point;
 
-    bool valid(const monster* a) const;
+    bool valid() const;
     void advance();
 };
 
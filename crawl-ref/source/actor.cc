@@ -9,6 +9,7 @@
 #include "areas.h"
 #include "art-enum.h"
 #include "attack.h"
+#include "beam.h"
 #include "chardump.h"
 #include "delay.h"
 #include "directn.h"
@@ -146,6 +147,7 @@ void actor::set_position(const coord_def &c)
     position = c;
     los_actor_moved(this, oldpos);
     areas_actor_moved(this, oldpos);
+    invalidate_tracer_cache();
 }
 
 bool actor::can_hibernate(bool holi_only, bool intrinsic_only) const
@@ -1040,14 +1040,15 @@ static void _get_randart_properties(const item_def &item,
 void setup_unrandart(item_def &item, bool creating)
 {
     ASSERT(is_unrandom_artefact(item));
-    CrawlVector &rap = item.props[ARTEFACT_PROPS_KEY].get_vector();
     const unrandart_entry *unrand = _seekunrandart(item);
 
-    if (unrand->prpty[ARTP_NO_UPGRADE] && !creating)
+    if (unrand->prpty[ARTP_NO_UPGRADE] && !creating && item.art_props)
         return; // don't mangle mutable items
 
+    item.art_props.init();
     for (int i = 0; i < ART_PROPERTIES; i++)
-        rap[i] = static_cast<short>(unrand->prpty[i]);
+        item.art_props[i] = static_cast<short>(unrand->prpty[i]);
+    you.invalidate_artefact_totals();
 
     item.base_type = unrand->base_type;
     item.sub_type  = unrand->sub_type;
@@ -1064,9 +1065,7 @@ static bool _init_artefact_properties(item_def &item)
         return true;
     }
 
-    CrawlVector &rap = item.props[ARTEFACT_PROPS_KEY].get_vector();
-    for (vec_size i = 0; i < ART_PROPERTIES; i++)
-        rap[i] = static_cast<short>(0);
+    item.art_props.init();
 
     ASSERT(item.base_type != OBJ_BOOKS);
 
@@ -1075,7 +1074,8 @@ static bool _init_artefact_properties(item_def &item)
     _get_randart_properties(item, prop);
 
     for (int i = 0; i < ART_PROPERTIES; i++)
-        rap[i] = static_cast<short>(prop[i]);
+        item.art_props[i] = static_cast<short>(prop[i]);
+    you.invalidate_artefact_totals();
 
     return true;
 }
@@ -1111,18 +1111,12 @@ void artefact_properties(const item_def &item,
 {
     ASSERT(is_artefact(item));
     ASSERT(item.base_type != OBJ_BOOKS);
-    ASSERT(item.props.exists(ARTEFACT_PROPS_KEY) || is_unrandom_artefact(item));
+    ASSERT(item.art_props || is_unrandom_artefact(item));
 
-    if (item.props.exists(ARTEFACT_PROPS_KEY))
+    if (item.art_props)
     {
-        const CrawlVector &rap_vec =
-            item.props[ARTEFACT_PROPS_KEY].get_vector();
-        ASSERT(rap_vec.get_type()     == SV_SHORT);
-        ASSERT(rap_vec.size()         == ART_PROPERTIES);
-        ASSERT(rap_vec.get_max_size() == ART_PROPERTIES);
-
-        for (vec_size i = 0; i < ART_PROPERTIES; i++)
-            proprt[i] = rap_vec[i].get_short();
+        for (int i = 0; i < ART_PROPERTIES; i++)
+            proprt[i] = item.art_props[i];
     }
     else // if (is_unrandom_artefact(item))
     {
@@ -1137,13 +1131,9 @@ int artefact_property(const item_def &item, artefact_prop_type prop)
 {
     ASSERT(is_artefact(item));
     ASSERT(item.base_type != OBJ_BOOKS);
-    ASSERT(item.props.exists(ARTEFACT_PROPS_KEY) || is_unrandom_artefact(item));
-    if (item.props.exists(ARTEFACT_PROPS_KEY))
-    {
-        const CrawlVector &rap_vec =
-            item.props[ARTEFACT_PROPS_KEY].get_vector();
-        return rap_vec[prop].get_short();
-    }
+    ASSERT(item.art_props || is_unrandom_artefact(item));
+    if (item.art_props)
+        return item.art_props[prop];
     else // if (is_unrandom_artefact(item))
     {
         const unrandart_entry *unrand = _seekunrandart(item);
@@ -1697,14 +1687,7 @@ bool randart_is_bad(const item_def &item)
 static void _artefact_setup_prop_vectors(item_def &item)
 {
     CrawlHashTable &props = item.props;
-    if (!props.exists(ARTEFACT_PROPS_KEY))
-        props[ARTEFACT_PROPS_KEY].new_vector(SV_SHORT).resize(ART_PROPERTIES);
-
-    CrawlVector &rap = props[ARTEFACT_PROPS_KEY].get_vector();
-    rap.set_max_size(ART_PROPERTIES);
-
-    for (vec_size i = 0; i < ART_PROPERTIES; i++)
-        rap[i].get_short() = 0;
+    item.art_props.init();
 
     if (!item.props.exists(KNOWN_PROPS_KEY))
     {
@@ -1757,9 +1740,10 @@ bool make_item_randart(item_def &item, bool force_mundane)
         {
             // Something went wrong that no amount of rerolling will fix.
             item.unrand_idx = 0;
-            item.props.erase(ARTEFACT_PROPS_KEY);
+            item.art_props.reset();
             item.props.erase(KNOWN_PROPS_KEY);
             item.flags &= ~ISFLAG_RANDART;
+            you.invalidate_artefact_totals();
             return false;
         }
     }
@@ -1872,6 +1856,7 @@ static void _make_faerie_armour(item_def &item)
         = item.props[ARTEFACT_APPEAR_KEY].get_string();
     doodad.props.erase(ARTEFACT_NAME_KEY);
     item.props = doodad.props;
+    item.art_props = doodad.art_props;
 
     // On body armour, an enchantment of less than 0 is never viable.
     int high_plus = random2(6) - 2;
@@ -1989,14 +1974,10 @@ void unrand_death_effects(monster* mons, killer_type killer)
 void artefact_set_property(item_def &item, artefact_prop_type prop, int val)
 {
     ASSERT(is_artefact(item));
-    ASSERT(item.props.exists(ARTEFACT_PROPS_KEY));
-
-    CrawlVector &rap_vec = item.props[ARTEFACT_PROPS_KEY].get_vector();
-    ASSERT(rap_vec.get_type()     == SV_SHORT);
-    ASSERT(rap_vec.size()         == ART_PROPERTIES);
-    ASSERT(rap_vec.get_max_size() == ART_PROPERTIES);
+    ASSERT(item.art_props);
 
-    rap_vec[prop].get_short() = val;
+    item.art_props[prop] = val;
+    you.invalidate_artefact_totals();
 }
 
 template<typename Z>
@@ -2018,7 +1999,15 @@ void artefact_fixup_props(item_def &item)
 {
     CrawlHashTable &props = item.props;
     if (props.exists(ARTEFACT_PROPS_KEY))
+    {
+        // Saves keep the values in props; in play they live in art_props.
         artefact_pad_store_vector(props[ARTEFACT_PROPS_KEY], short(0));
+        const CrawlVector &rap = props[ARTEFACT_PROPS_KEY].get_vector();
+        item.art_props.init();
+        for (int i = 0; i < ART_PROPERTIES; i++)
+            item.art_props[i] = rap[i].get_short();
+        props.erase(ARTEFACT_PROPS_KEY);
+    }
 
     if (props.exists(KNOWN_PROPS_KEY))
         artefact_pad_store_vector(props[KNOWN_PROPS_KEY], false);
@@ -2031,7 +2020,7 @@ void artefact_fixup_props(item_def &item)
     // https://crawl.develz.org/mantis/view.php?id=11756 - see also abyss.cc.
     if (item.base_type == OBJ_WEAPONS
         && (item.flags & (ISFLAG_SUMMONED | ISFLAG_RANDART))
-        && !item.props.exists(ARTEFACT_PROPS_KEY))
+        && !item.art_props)
     {
         item.flags &= ~ISFLAG_RANDART;
     }
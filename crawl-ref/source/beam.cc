@@ -1111,22 +1111,51 @@ void bolt::affect_cell()
         affect_ground();
 }
 
-static void _undo_tracer(bolt &orig, bolt &copy)
-{
-    // FIXME: we should have a better idea of what gets changed!
-    orig.target           = copy.target;
-    orig.source           = copy.source;
-    orig.aimed_at_spot    = copy.aimed_at_spot;
-    orig.aimed_at_feet    = copy.aimed_at_feet;
-    orig.extra_range_used = copy.extra_range_used;
-    orig.auto_hit         = copy.auto_hit;
-    orig.ray              = copy.ray;
-    orig.colour           = copy.colour;
-    orig.flavour          = copy.flavour;
-    orig.real_flavour     = copy.real_flavour;
-    orig.bounces          = copy.bounces;
-    orig.bounce_pos       = copy.bounce_pos;
-}
+// The parts of a bolt that firing it moves around, and that a tracer has
+// to put back so that the bolt can then be fired for real. Tracers are
+// fired several times per monster per turn, so only these are kept rather
+// than a copy of the whole bolt.
+struct bolt_tracer_state
+{
+    explicit bolt_tracer_state(const bolt &b)
+        : target(b.target), source(b.source),
+          aimed_at_spot(b.aimed_at_spot), aimed_at_feet(b.aimed_at_feet),
+          extra_range_used(b.extra_range_used), auto_hit(b.auto_hit),
+          ray(b.ray), colour(b.colour), flavour(b.flavour),
+          real_flavour(b.real_flavour), bounces(b.bounces),
+          bounce_pos(b.bounce_pos)
+    {
+    }
+
+    void restore(bolt &b) const
+    {
+        b.target           = target;
+        b.source           = source;
+        b.aimed_at_spot    = aimed_at_spot;
+        b.aimed_at_feet    = aimed_at_feet;
+        b.extra_range_used = extra_range_used;
+        b.auto_hit         = auto_hit;
+        b.ray              = ray;
+        b.colour           = colour;
+        b.flavour          = flavour;
+        b.real_flavour     = real_flavour;
+        b.bounces          = bounces;
+        b.bounce_pos       = bounce_pos;
+    }
+
+    coord_def target;
+    coord_def source;
+    bool aimed_at_spot;
+    bool aimed_at_feet;
+    int extra_range_used;
+    bool auto_hit;
+    ray_def ray;
+    colour_t colour;
+    beam_type flavour;
+    beam_type real_flavour;
+    int bounces;
+    coord_def bounce_pos;
+};
 
 // This saves some important things before calling fire().
 void bolt::fire()
@@ -1138,19 +1167,15 @@ void bolt::fire()
 
     if (is_tracer)
     {
-        bolt boltcopy = *this;
-        if (special_explosion != nullptr)
-            boltcopy.special_explosion = new bolt(*special_explosion);
+        const bolt_tracer_state state(*this);
+        const bolt_tracer_state explosion_state(special_explosion
+                                                ? *special_explosion : *this);
 
         do_fire();
 
         if (special_explosion != nullptr)
-        {
-            _undo_tracer(*special_explosion, *boltcopy.special_explosion);
-            delete boltcopy.special_explosion;
-        }
-
-        _undo_tracer(*this, boltcopy);
+            explosion_state.restore(*special_explosion);
+        state.restore(*this);
     }
     else
         do_fire();
@@ -1216,11 +1241,15 @@ void bolt::do_fire()
 
         const dungeon_feature_type feat = env.grid(pos());
 
-        if (in_bounds(target)
+        // If it's a player tracer...
+        // (!is_targeting so you don't get prompted while adjusting the aim)
+        // (checked first, as monster tracers are far more common)
+        if (is_tracer && !is_targeting && YOU_KILL(thrower)
+            && in_bounds(target)
             // Starburst beams are essentially untargeted; some might even hit
             // a victim if others have LOF blocked.
             && origin_spell != SPELL_STARBURST
-            // We ran into a solid wall with a real beam...
+            // and we ran into a solid wall with a real beam...
             && (feat_is_solid(feat)
                 && flavour != BEAM_DIGGING && flavour <= BEAM_LAST_REAL
                 && !cell_is_solid(target)
@@ -1230,9 +1259,6 @@ void bolt::do_fire()
                    && you.can_see(*monster_at(pos()))
                    && !ignores_monster(monster_at(pos()))
                    && mons_is_firewood(*monster_at(pos())))
-            // and it's a player tracer...
-            // (!is_targeting so you don't get prompted while adjusting the aim)
-            && is_tracer && !is_targeting && YOU_KILL(thrower)
             // and we're actually between you and the target...
             && !passed_target && pos() != target && pos() != source
             // ?
@@ -2086,16 +2112,158 @@ int silver_damages_victim(actor* victim, int damage, string &dmg_msg)
     return ret;
 }
 
+// Everything about a bolt (and the world) that a monster tracer's outcome
+// depends on. Positions of actors and terrain aren't in here, so the cache
+// is forgotten whenever those change. Nor are hit points or enchantments,
+// so it only lives for one monster's move (see tracer_cache_scope).
+struct tracer_key
+{
+    tracer_key(const bolt &b, bool explode_only_, bool explosion_hole_)
+        : source(b.source), target(b.target), source_id(b.source_id),
+          range(b.range), flavour(b.flavour), real_flavour(b.real_flavour),
+          origin_spell(b.origin_spell), damage_num(b.damage.num),
+          damage_size(b.damage.size), ench_power(b.ench_power), hit(b.hit),
+          thrower(b.thrower), ex_size(b.ex_size), attitude(b.attitude),
+          ac_rule(b.ac_rule), item(b.item), name(b.name), pierce(b.pierce),
+          is_explosion(b.is_explosion), is_death_effect(b.is_death_effect),
+          aimed_at_spot(b.aimed_at_spot), aimed_at_feet(b.aimed_at_feet),
+          affects_nothing(b.affects_nothing), drop_item(b.drop_item),
+          use_target_as_pos(b.use_target_as_pos), auto_hit(b.auto_hit),
+          explode_only(explode_only_), explosion_hole(explosion_hole_)
+    {
+    }
+
+    bool operator==(const tracer_key &o) const
+    {
+        return source == o.source && target == o.target
+               && source_id == o.source_id && range == o.range
+               && flavour == o.flavour && real_flavour == o.real_flavour
+               && origin_spell == o.origin_spell
+               && damage_num == o.damage_num && damage_size == o.damage_size
+               && ench_power == o.ench_power && hit == o.hit
+               && thrower == o.thrower && ex_size == o.ex_size
+               && attitude == o.attitude && ac_rule == o.ac_rule
+               && item == o.item && pierce == o.pierce
+               && is_explosion == o.is_explosion
+               && is_death_effect == o.is_death_effect
+               && aimed_at_spot == o.aimed_at_spot
+               && aimed_at_feet == o.aimed_at_feet
+               && affects_nothing == o.affects_nothing
+               && drop_item == o.drop_item
+               && use_target_as_pos == o.use_target_as_pos
+               && auto_hit == o.auto_hit
+               && explode_only == o.explode_only
+               && explosion_hole == o.explosion_hole
+               && name == o.name;
+    }
+
+    coord_def source, target;
+    mid_t source_id;
+    int range;
+    beam_type flavour, real_flavour;
+    spell_type origin_spell;
+    int damage_num, damage_size, ench_power, hit;
+    killer_type thrower;
+    int ex_size;
+    mon_attitude_type attitude;
+    ac_type ac_rule;
+    const item_def* item;
+    string name;
+    bool pierce, is_explosion, is_death_effect, aimed_at_spot, aimed_at_feet,
+         affects_nothing, drop_item, use_target_as_pos, auto_hit,
+         explode_only, explosion_hole;
+};
+
+// What firing a tracer leaves behind in the bolt.
+struct tracer_result
+{
+    explicit tracer_result(const bolt &b)
+        : foe_info(b.foe_info), friend_info(b.friend_info),
+          path_taken(b.path_taken), reflector(b.reflector),
+          reflections(b.reflections), seen(b.seen), heard(b.heard),
+          is_explosion(b.is_explosion),
+          in_explosion_phase(b.in_explosion_phase),
+          passed_target(b.passed_target),
+          friendly_past_target(b.friendly_past_target),
+          beam_cancelled(b.beam_cancelled)
+    {
+    }
+
+    void apply(bolt &b) const
+    {
+        b.foe_info             = foe_info;
+        b.friend_info          = friend_info;
+        b.path_taken           = path_taken;
+        b.reflector            = reflector;
+        b.reflections          = reflections;
+        b.seen                 = seen;
+        b.heard                = heard;
+        b.is_explosion         = is_explosion;
+        b.in_explosion_phase   = in_explosion_phase;
+        b.passed_target        = passed_target;
+        b.friendly_past_target = friendly_past_target;
+        b.beam_cancelled       = beam_cancelled;
+    }
+
+    tracer_info foe_info;
+    tracer_info friend_info;
+    vector<coord_def> path_taken;
+    mid_t reflector;
+    int reflections;
+    bool seen, heard, is_explosion, in_explosion_phase, passed_target,
+         friendly_past_target, beam_cancelled;
+};
+
+static vector<pair<tracer_key, tracer_result>> tracer_cache;
+static int tracer_cache_users = 0;
+#ifdef DEBUG
+static tracer_cache_stats tracer_stats;
+
+tracer_cache_stats get_tracer_cache_stats()
+{
+    return tracer_stats;
+}
+#endif
+
+void invalidate_tracer_cache()
+{
+    tracer_cache.clear();
+}
+
+tracer_cache_scope::tracer_cache_scope()
+{
+    ++tracer_cache_users;
+    invalidate_tracer_cache();
+}
+
+tracer_cache_scope::~tracer_cache_scope()
+{
+    ASSERT(tracer_cache_users > 0);
+    --tracer_cache_users;
+    invalidate_tracer_cache();
+}
+
+static tracer_summary _summarise_tracer(const bolt &pbolt)
+{
+    tracer_summary summary;
+    summary.foe_info = pbolt.foe_info;
+    summary.friend_info = pbolt.friend_info;
+    summary.stop = pbolt.path_taken.empty() ? pbolt.source
+                                            : pbolt.path_taken.back();
+    return summary;
+}
+
 //  Used by monsters in "planning" which spell to cast. Fires off a "tracer"
 //  which tells the monster what it'll hit if it breathes/casts etc.
 //
 //  The output from this tracer function is written into the
-//  tracer_info variables (friend_info and foe_info).
+//  tracer_info variables (friend_info and foe_info) and path_taken, and
+//  is also returned in brief for callers that need nothing more.
 //
 //  Note that beam properties must be set, as the tracer will take them
 //  into account, as well as the monster's intelligence.
-void fire_tracer(const monster* mons, bolt &pbolt, bool explode_only,
-                 bool explosion_hole)
+tracer_summary fire_tracer(const monster* mons, bolt &pbolt, bool explode_only,
+                           bool explosion_hole)
 {
     // If this ASSERT triggers, your spell's setup code probably is doing
     // something bad when setup_mons_cast is called with check_validity=true.
@@ -2137,14 +2305,47 @@ void fire_tracer(const monster* mons, bolt &pbolt, bool explode_only,
 
     pbolt.in_explosion_phase = false;
 
+    // Spell selection often fires the same tracer more than once. Special
+    // explosions and preset rays carry more state than the key covers.
+    const bool cacheable = tracer_cache_users
+                           && !pbolt.special_explosion && !pbolt.chose_ray;
+    const tracer_key key(pbolt, explode_only, explosion_hole);
+    if (cacheable)
+    {
+        for (const auto &entry : tracer_cache)
+        {
+            if (entry.first == key)
+            {
+#ifdef DEBUG
+                ++tracer_stats.hits;
+#endif
+                entry.second.apply(pbolt);
+                pbolt.is_tracer = false;
+                return _summarise_tracer(pbolt);
+            }
+        }
+#ifdef DEBUG
+        ++tracer_stats.misses;
+#endif
+    }
+
+    // Only remember tracers that didn't roll anything, so replaying one
+    // leaves the RNG where firing it would have.
+    const uint64_t rng_before = rng::peek_uint64();
+
     // Fire!
     if (explode_only)
         pbolt.explode(false, explosion_hole);
     else
         pbolt.fire();
 
+    if (cacheable && rng::peek_uint64() == rng_before)
+        tracer_cache.emplace_back(key, tracer_result(pbolt));
+
     // Unset tracer flag (convenience).
     pbolt.is_tracer = false;
+
+    return _summarise_tracer(pbolt);
 }
 
 set<coord_def> create_feat_splash(coord_def center,
@@ -52,6 +52,14 @@ struct tracer_info
     const tracer_info &operator += (const tracer_info &other);
 };
 
+// What a monster's tracer found, without the rest of the bolt.
+struct tracer_summary
+{
+    tracer_info foe_info;              // foes in the way
+    tracer_info friend_info;           // friends in the way
+    coord_def stop;                    // where the beam stopped
+};
+
 struct bolt
 {
     bolt();
@@ -347,8 +355,28 @@ bool napalm_monster(monster* mons, const actor* who, int levels = 1,
 bool curare_actor(actor* source, actor* target, int levels, string name,
                   string source_name);
 int silver_damages_victim(actor* victim, int damage, string &dmg_msg);
-void fire_tracer(const monster* mons, bolt &pbolt,
-                  bool explode_only = false, bool explosion_hole = false);
+tracer_summary fire_tracer(const monster* mons, bolt &pbolt,
+                           bool explode_only = false,
+                           bool explosion_hole = false);
+void invalidate_tracer_cache();
+// fire_tracer() only reuses results while one of these is alive. They are
+// forgotten whenever one starts or ends, so a nested monster move starts
+// afresh and the outer one doesn't see anything from before it.
+class tracer_cache_scope
+{
+public:
+    tracer_cache_scope();
+    ~tracer_cache_scope();
+};
+#ifdef DEBUG
+// How often fire_tracer() could reuse an earlier tracer.
+struct tracer_cache_stats
+{
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+};
+tracer_cache_stats get_tracer_cache_stats();
+#endif
 spret zapping(zap_type ztype, int power, bolt &pbolt,
                    bool needs_tracer = false, const char* msg = nullptr,
                    bool fail = false);
@@ -0,0 +1,99 @@
+#include <map>
+#include <random>
+
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "env.h"
+
+TEST_CASE("cloud_grid behaves like a map of clouds", "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 6));
+    CAPTURE(seed);
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> xs(0, GXM - 1), ys(0, GYM - 1);
+    std::uniform_int_distribution<int> op(0, 2);
+
+    cloud_grid grid;
+    map<coord_def, cloud_struct> reference;
+    for (int i = 0; i < 3000; ++i)
+    {
+        const coord_def p(xs(gen), ys(gen));
+        if (op(gen))
+        {
+            grid[p].pos = p;
+            grid[p].decay = i;
+            reference[p].pos = p;
+            reference[p].decay = i;
+        }
+        else
+        {
+            grid.erase(p);
+            reference.erase(p);
+        }
+    }
+
+    REQUIRE(grid.size() == (int) reference.size());
+    auto ref = reference.begin();
+    for (const cloud_struct &cloud : grid)
+    {
+        REQUIRE(ref != reference.end());
+        REQUIRE(cloud.pos == ref->first);
+        REQUIRE(cloud.decay == ref->second.decay);
+        ++ref;
+    }
+    REQUIRE(ref == reference.end());
+
+    SECTION("erasing while iterating visits every cloud once")
+    {
+        int seen = 0;
+        for (const cloud_struct &cloud : grid)
+        {
+            ++seen;
+            grid.erase(cloud.pos);
+        }
+        REQUIRE(seen == (int) reference.size());
+        REQUIRE(grid.size() == 0);
+        REQUIRE(!(grid.begin() != grid.end()));
+    }
+
+    SECTION("clouds keep their address until erased")
+    {
+        const coord_def first = reference.begin()->first;
+        const cloud_struct *addr = grid.find(first);
+        for (int x = 0; x < GXM; ++x)
+            grid[coord_def(x, 0)].pos = coord_def(x, 0);
+        REQUIRE(grid.find(first) == addr);
+    }
+
+    SECTION("clouds made after a mark can be told apart")
+    {
+        const unsigned int mark = grid.serial();
+        coord_def p(0, 0);
+        while (grid.find(p))
+            ++p.x;
+        grid[p].pos = p;
+        REQUIRE(grid.made_since(p, mark));
+        REQUIRE(!grid.made_since(reference.begin()->first, mark));
+    }
+
+    SECTION("saved cells are put back as they were")
+    {
+        const coord_def kept = reference.begin()->first;
+        coord_def empty(0, 0);
+        while (grid.find(empty))
+            ++empty.x;
+        const unsigned int mark = grid.serial();
+        {
+            cloud_grid::saved_cells saved(grid, { kept, empty });
+            grid.erase(kept);
+            grid[empty].pos = empty;
+        }
+        REQUIRE(grid.find(kept));
+        REQUIRE(grid.find(kept)->decay == reference.begin()->second.decay);
+        REQUIRE(!grid.made_since(kept, mark));
+        REQUIRE(!grid.find(empty));
+        REQUIRE(grid.size() == (int) reference.size());
+    }
+}
@@ -3,8 +3,13 @@
 #include "AppHdr.h"
 
 #include "files.h"
+#include "package.h"
+#include "player.h"
+#include "player-save-info.h"
 #include "random.h"
+#include "syscalls.h"
 #include "tags.h"
+#include "unwind.h"
 
 TEST_CASE( "Test save version reading/writing works", "[single-file]" ) {
 
@@ -100,3 +105,42 @@ TEST_CASE( "Test save version reading/writing works", "[single-file]" ) {
         }
     }
 }
+
+TEST_CASE( "Save summaries can be read back as character info",
+           "[single-file]" ) {
+    const char *file = "test-summary.tmp";
+    unwind_var<string> name(you.your_name, "Summarised");
+    unwind_var<int> xl(you.experience_level, 7);
+
+    SECTION ("from the summary alone") {
+        {
+            // No "chr" chunk, so this only works if the summary is used.
+            package save(file, true, true);
+            chunk_writer w(&save, "data");
+            w.write("x", 1);
+            save.set_summary(save_summary());
+        }
+        const player_save_info p = read_save_info(file, false);
+        REQUIRE(p.name == "Summarised");
+        REQUIRE(p.experience_level == 7);
+    }
+
+    SECTION ("from the chunks if the summary is damaged") {
+        {
+            package save(file, true, true);
+            {
+                writer outf(&save, "chr");
+                write_save_version(outf, save_version::current());
+                tag_write(TAG_CHR, outf);
+            }
+            vector<unsigned char> summary = save_summary();
+            summary.resize(summary.size() / 2);
+            save.set_summary(summary);
+        }
+        const player_save_info p = read_save_info(file, false);
+        REQUIRE(p.name == "Summarised");
+        REQUIRE(p.experience_level == 7);
+    }
+
+    unlink_u(file);
+}
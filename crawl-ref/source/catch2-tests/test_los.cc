@@ -0,0 +1,296 @@
+#include <random>
+
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "coord-circle.h"
+#include "coordit.h"
+#include "env.h"
+#include "feature.h"
+#include "los-tables.h"
+#include "los.h"
+#include "losglobal.h"
+#include "ray.h"
+
+// Opacity given by a fixed random pattern of walls and clouds.
+class opacity_pattern : public opacity_func
+{
+public:
+    opacity_pattern(unsigned int seed, int wall_pct, int cloud_pct)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> pct(0, 99);
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            const int roll = pct(gen);
+            opc(*ri) = roll < wall_pct ? OPC_OPAQUE
+                     : roll < wall_pct + cloud_pct ? OPC_HALF
+                                                   : OPC_CLEAR;
+        }
+    }
+
+    CLONE(opacity_pattern)
+
+    opacity_type operator()(const coord_def& p) const override
+    {
+        return opc(p);
+    }
+
+private:
+    FixedArray<opacity_type, GXM, GYM> opc;
+};
+
+TEST_CASE( "losight agrees with find_ray", "[single-file]" ) {
+    const coord_def center(GXM / 2, GYM / 2);
+    const circle_def bounds(LOS_MAX_RANGE, C_SQUARE);
+
+    const auto seed = GENERATE(range(1, 21));
+    const auto wall_pct = GENERATE(0, 10, 30);
+    const auto cloud_pct = GENERATE(0, 15);
+    CAPTURE(seed, wall_pct, cloud_pct);
+
+    const opacity_pattern opc(seed, wall_pct, cloud_pct);
+    los_grid sh;
+    losight(sh, center, opc, bounds);
+
+    REQUIRE(sh(coord_def(0, 0)));
+    for (rectangle_iterator ri(coord_def(0, 0), LOS_MAX_RANGE); ri; ++ri)
+    {
+        if (ri->origin())
+            continue;
+        CAPTURE(ri->x, ri->y);
+        REQUIRE(sh(*ri) == exists_ray(center, center + *ri, opc));
+    }
+}
+
+TEST_CASE( "losight_many agrees with losight", "[single-file]" ) {
+    const auto threads = GENERATE(1, 4);
+    const auto bounds = GENERATE(circle_def(LOS_MAX_RANGE, C_SQUARE),
+                                 circle_def(5, C_ROUND));
+    CAPTURE(threads);
+    const opacity_pattern opc(7, 15, 10);
+
+    // Spread out, clustered, and near the map edge.
+    vector<coord_def> centers;
+    for (int i = 0; i < 12; ++i)
+        centers.emplace_back(3 + 6 * i, 2 + 5 * i);
+    for (int i = 0; i < 6; ++i)
+        centers.emplace_back(GXM / 2 + i, GYM / 2 - i);
+    centers.emplace_back(0, 0);
+    centers.emplace_back(GXM - 1, GYM - 1);
+
+    vector<los_grid> grids;
+    losight_many(grids, centers, opc, bounds, threads);
+    REQUIRE(grids.size() == centers.size());
+
+    for (size_t i = 0; i < centers.size(); ++i)
+    {
+        CAPTURE(centers[i].x, centers[i].y);
+        los_grid sh;
+        losight(sh, centers[i], opc, bounds);
+        for (rectangle_iterator ri(coord_def(0, 0), LOS_MAX_RANGE); ri; ++ri)
+        {
+            CAPTURE(ri->x, ri->y);
+            REQUIRE(grids[i](*ri) == sh(*ri));
+        }
+    }
+}
+
+// Like opacity_pattern, but with one cell made opaque.
+class opacity_with_wall : public opacity_func
+{
+public:
+    opacity_with_wall(const opacity_func& o, const coord_def& w)
+        : base(o), wall(w)
+    {
+    }
+
+    CLONE(opacity_with_wall)
+
+    opacity_type operator()(const coord_def& p) const override
+    {
+        return p == wall ? OPC_OPAQUE : base(p);
+    }
+
+private:
+    const opacity_func& base;
+    coord_def wall;
+};
+
+TEST_CASE( "Only cells in the LOS cone affect visibility", "[single-file]" ) {
+    const coord_def center(GXM / 2, GYM / 2);
+
+    const auto seed = GENERATE(range(1, 4));
+    CAPTURE(seed);
+    const opacity_pattern opc(seed, 5, 10);
+
+    for (rectangle_iterator ti(coord_def(0, 0), LOS_MAX_RANGE); ti; ++ti)
+    {
+        if (ti->origin())
+            continue;
+        const bool seen = exists_ray(center, center + *ti, opc);
+        for (rectangle_iterator ci(coord_def(0, 0), LOS_MAX_RANGE); ci; ++ci)
+        {
+            if (los_cell_affects(*ci, *ti))
+                continue;
+            CAPTURE(ti->x, ti->y, ci->x, ci->y);
+            const opacity_with_wall walled(opc, center + *ci);
+            REQUIRE(exists_ray(center, center + *ti, walled) == seen);
+        }
+    }
+}
+
+TEST_CASE( "Generated ray tables match the ray geometry", "[single-file]" ) {
+
+    SECTION ("fullray footprints are where the rays go") {
+        for (const los_table_ray &fr : los_fullrays)
+        {
+            ray_def ray(geom::ray(fr.start_x, fr.start_y, fr.dir_x, fr.dir_y));
+            unsigned int i = 0;
+            while (ray.advance() && ray.pos().rdist() <= LOS_RADIUS)
+            {
+                REQUIRE(i < fr.length);
+                REQUIRE(ray.pos() == los_ray_coords[fr.start + i]);
+                ++i;
+            }
+            REQUIRE(i == fr.length);
+        }
+    }
+
+    SECTION ("minimal cellrays end at their targets") {
+        unsigned int n = 0;
+        for (rectangle_iterator ri(coord_def(0, 0),
+                                   coord_def(LOS_MAX_RANGE, LOS_MAX_RANGE));
+             ri; ++ri)
+        {
+            const int i = ri->y * (LOS_MAX_RANGE+1) + ri->x;
+            REQUIRE(los_min_cellrays_first[i] == n);
+            for (; n < los_min_cellrays_first[i + 1]; ++n)
+            {
+                const los_table_cellray &c = los_min_cellrays[n];
+                const los_table_ray &fr = los_fullrays[c.ray];
+                REQUIRE(c.end < fr.length);
+                REQUIRE(los_ray_coords[fr.start + c.end] == *ri);
+            }
+            REQUIRE((n > los_min_cellrays_first[i]) == !ri->origin());
+        }
+        REQUIRE(n == LOS_NUM_CELLRAYS);
+    }
+}
+
+TEST_CASE( "find_ray caches rays until LOS changes", "[single-file]" ) {
+    init_show_table();
+    const auto old_grid = env.grid;
+
+    const coord_def source(20, 20);
+    const coord_def target(24, 20);
+    for (rectangle_iterator ri(source, LOS_MAX_RANGE); ri; ++ri)
+        env.grid(*ri) = ri->x == 22 ? DNGN_ROCK_WALL : DNGN_FLOOR;
+    los_changed();
+
+    const los_ray_cache_stats before = find_ray_cache_stats();
+    REQUIRE_FALSE(exists_ray(source, target, opc_solid));
+    REQUIRE_FALSE(exists_ray(source, target, opc_solid));
+    const los_ray_cache_stats after = find_ray_cache_stats();
+    REQUIRE(after.misses == before.misses + 1);
+    REQUIRE(after.hits == before.hits + 1);
+
+    for (rectangle_iterator ri(source, LOS_MAX_RANGE); ri; ++ri)
+        if (ri->x == 22)
+        {
+            env.grid(*ri) = DNGN_FLOOR;
+            los_terrain_changed(*ri);
+        }
+    REQUIRE(exists_ray(source, target, opc_solid));
+
+    env.grid = old_grid;
+    los_changed();
+}
+
+TEST_CASE( "prefetch_los gives the same answers as lazy lookups",
+           "[single-file]" ) {
+    init_show_table();
+    const auto old_grid = env.grid;
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> pct(0, 99);
+    for (rectangle_iterator ri(1); ri; ++ri)
+        env.grid(*ri) = pct(gen) < 20 ? DNGN_ROCK_WALL : DNGN_FLOOR;
+
+    vector<coord_def> centers;
+    for (int i = 0; i < 8; ++i)
+        centers.emplace_back(10 + 7 * i, 5 + 2 * i);
+    centers.emplace_back(centers[0]);
+
+    invalidate_los();
+    vector<bool> lazy;
+    for (const coord_def &c : centers)
+        for (rectangle_iterator ri(c, LOS_MAX_RANGE); ri; ++ri)
+            lazy.push_back(cell_see_cell(c, *ri, LOS_SOLID));
+
+    invalidate_los();
+    prefetch_los(centers, LOS_SOLID, 4);
+    size_t i = 0;
+    for (const coord_def &c : centers)
+        for (rectangle_iterator ri(c, LOS_MAX_RANGE); ri; ++ri)
+        {
+            CAPTURE(c.x, c.y, ri->x, ri->y);
+            REQUIRE(cell_see_cell(c, *ri, LOS_SOLID) == lazy[i++]);
+        }
+
+    env.grid = old_grid;
+    invalidate_los();
+    los_changed();
+}
+
+TEST_CASE( "invalidate_los_around forgets every pair a change affects",
+           "[single-file]" ) {
+    init_show_table();
+    const auto old_grid = env.grid;
+
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> pct(0, 99);
+    for (rectangle_iterator ri(1); ri; ++ri)
+        env.grid(*ri) = pct(gen) < 20 ? DNGN_ROCK_WALL : DNGN_FLOOR;
+
+    const auto changed = GENERATE(coord_def(GXM / 2, GYM / 2),
+                                  coord_def(3, GYM - 4));
+    const auto los = GENERATE(LOS_DEFAULT, LOS_SOLID);
+    CAPTURE(changed.x, changed.y, los);
+
+    // Every pair with an end in range of the changed cell, so every pair
+    // whose ray could cross it.
+    const auto lookup_all = [&]()
+    {
+        vector<bool> seen;
+        for (rectangle_iterator si(changed, LOS_MAX_RANGE); si; ++si)
+            for (rectangle_iterator ri(*si, LOS_MAX_RANGE); ri; ++ri)
+                seen.push_back(cell_see_cell(*si, *ri, los));
+        return seen;
+    };
+
+    invalidate_los();
+    lookup_all();
+
+    env.grid(changed) = env.grid(changed) == DNGN_ROCK_WALL ? DNGN_FLOOR
+                                                            : DNGN_ROCK_WALL;
+    invalidate_los_around(changed);
+    const vector<bool> patched = lookup_all();
+
+    invalidate_los();
+    const vector<bool> fresh = lookup_all();
+
+    REQUIRE(patched.size() == fresh.size());
+    size_t i = 0;
+    for (rectangle_iterator si(changed, LOS_MAX_RANGE); si; ++si)
+        for (rectangle_iterator ri(*si, LOS_MAX_RANGE); ri; ++ri, ++i)
+        {
+            CAPTURE(si->x, si->y, ri->x, ri->y);
+            REQUIRE(patched[i] == fresh[i]);
+        }
+
+    env.grid = old_grid;
+    invalidate_los();
+    los_changed();
+}
@@ -0,0 +1,238 @@
+#include <random>
+
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "package.h"
+#include "stringutil.h"
+#include "syscalls.h"
+
+// Compressible, but not trivially so.
+static vector<char> _test_chunk_data()
+{
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> byte(0, 255);
+    vector<char> data(200000);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = byte(gen) < 64 ? byte(gen) : 'a' + i % 26;
+    return data;
+}
+
+static vector<save_codec> _available_codecs()
+{
+    vector<save_codec> codecs;
+    for (int i = 0; i < static_cast<int>(save_codec::NUM_SAVE_CODECS); ++i)
+        if (save_codec_available(static_cast<save_codec>(i)))
+            codecs.push_back(static_cast<save_codec>(i));
+    return codecs;
+}
+
+TEST_CASE( "Chunks can be read back whatever codec wrote them",
+           "[single-file]" ) {
+    const char *file = "test-package.tmp";
+    const vector<char> data = _test_chunk_data();
+    const vector<save_codec> codecs = _available_codecs();
+    REQUIRE(save_codec_available(save_codec::none));
+
+    {
+        package save(file, true, true);
+        for (save_codec codec : codecs)
+        {
+            REQUIRE(save.set_codec(codec));
+            chunk_writer w(&save, save_codec_name(codec));
+            w.write(data.data(), data.size());
+        }
+    }
+
+    {
+        package save(file, false);
+        for (save_codec codec : codecs)
+        {
+            CAPTURE(save_codec_name(codec));
+            REQUIRE(save.chunk_codec(save_codec_name(codec)) == codec);
+            chunk_reader r(&save, save_codec_name(codec));
+            vector<char> back;
+            r.read_all(back);
+            REQUIRE(back == data);
+        }
+    }
+
+    unlink_u(file);
+}
+
+TEST_CASE( "Asking for a codec the build lacks changes nothing",
+           "[single-file]" ) {
+    package save;
+    const save_codec before = save.get_codec();
+    for (int i = 0; i < static_cast<int>(save_codec::NUM_SAVE_CODECS); ++i)
+    {
+        const save_codec codec = static_cast<save_codec>(i);
+        if (save_codec_available(codec))
+            continue;
+        REQUIRE_FALSE(save.set_codec(codec));
+        REQUIRE(save.get_codec() == before);
+    }
+    // An empty package has nothing to commit.
+    save.abort();
+}
+
+TEST_CASE( "Background commits keep chunks readable throughout",
+           "[single-file]" ) {
+    const char *file = "test-package-bg.tmp";
+    const vector<char> data = _test_chunk_data();
+    const vector<char> other(1000, 'x');
+
+    {
+        package save(file, true, true);
+        save.set_background(true);
+        for (int i = 0; i < 4; ++i)
+        {
+            chunk_writer w(&save, make_stringf("level%d", i));
+            w.write(data.data(), data.size());
+        }
+        save.commit();
+
+        // Written while the commit above may still be under way.
+        {
+            chunk_writer w(&save, "pending");
+            w.write(other.data(), other.size());
+        }
+        REQUIRE(save.has_chunk("pending"));
+        REQUIRE(save.has_chunk("level3"));
+        {
+            chunk_reader r(&save, "pending");
+            vector<char> back;
+            r.read_all(back);
+            REQUIRE(back == other);
+        }
+
+        {
+            chunk_writer w(&save, "dropped");
+            w.write(other.data(), other.size());
+        }
+        {
+            // Readers keep what the chunk held when they started.
+            chunk_reader r(&save, "dropped");
+            {
+                chunk_writer w(&save, "dropped");
+                w.write(data.data(), data.size());
+            }
+            vector<char> back;
+            r.read_all(back);
+            REQUIRE(back == other);
+        }
+        save.delete_chunk("dropped");
+        save.delete_chunk("level0");
+        REQUIRE_FALSE(save.has_chunk("dropped"));
+        save.commit();
+    }
+
+    {
+        package save(file, false);
+        REQUIRE(save.list_chunks().size() == 4);
+        REQUIRE_FALSE(save.has_chunk("level0"));
+        for (int i = 1; i < 4; ++i)
+        {
+            chunk_reader r(&save, make_stringf("level%d", i));
+            vector<char> back;
+            r.read_all(back);
+            REQUIRE(back == data);
+        }
+        chunk_reader r(&save, "pending");
+        vector<char> back;
+        r.read_all(back);
+        REQUIRE(back == other);
+    }
+
+    unlink_u(file);
+}
+
+TEST_CASE( "Read-only and writeable packages read chunks alike",
+           "[single-file]" ) {
+    const char *file = "test-package-ro.tmp";
+    const vector<char> data = _test_chunk_data();
+    const auto codec = GENERATE(save_codec::none, save_codec::zlib);
+
+    {
+        package save(file, true, true);
+        REQUIRE(save.set_codec(codec));
+        // Interleave the chunks, so that their blocks are chained up.
+        chunk_writer a(&save, "a");
+        chunk_writer b(&save, "b");
+        for (size_t at = 0; at < data.size(); at += 1000)
+        {
+            const plen_t len = min<size_t>(1000, data.size() - at);
+            a.write(&data[at], len);
+            b.write(&data[data.size() - at - len], len);
+        }
+    }
+
+    // Read-only packages are read through a mapping of the file, where
+    // mmap is available, writeable ones never are.
+    vector<char> ro_a, ro_b, rw_a, rw_b;
+    {
+        package save(file, false);
+        chunk_reader(&save, "a").read_all(ro_a);
+        chunk_reader(&save, "b").read_all(ro_b);
+    }
+    {
+        package save(file, true);
+        chunk_reader(&save, "a").read_all(rw_a);
+        chunk_reader(&save, "b").read_all(rw_b);
+        save.abort();
+    }
+    REQUIRE(ro_a == data);
+    REQUIRE(rw_a == data);
+    REQUIRE(ro_b == rw_b);
+    REQUIRE(ro_b.size() == data.size());
+
+    unlink_u(file);
+}
+
+TEST_CASE( "The summary can be read without loading the package",
+           "[single-file]" ) {
+    const char *file = "test-package-summary.tmp";
+    const vector<char> data = _test_chunk_data();
+    vector<unsigned char> summary;
+    for (int i = 0; i < 300; ++i)
+        summary.push_back(i * 7);
+
+    {
+        package save(file, true, true);
+        chunk_writer w(&save, "data");
+        w.write(data.data(), data.size());
+    }
+    vector<unsigned char> got;
+    REQUIRE_FALSE(package::read_summary(file, got));
+
+    {
+        package save(file, true);
+        save.set_summary(summary);
+        save.commit();
+        // The summary is never mistaken for free space.
+        chunk_writer w(&save, "more");
+        w.write(data.data(), data.size());
+    }
+    REQUIRE(package::read_summary(file, got));
+    REQUIRE(got == summary);
+
+    {
+        package save(file, false);
+        vector<char> back;
+        chunk_reader(&save, "data").read_all(back);
+        REQUIRE(back == data);
+        back.clear();
+        chunk_reader(&save, "more").read_all(back);
+        REQUIRE(back == data);
+    }
+
+    // Too big to keep: readers are sent back to the chunks.
+    {
+        package save(file, true);
+        save.set_summary(vector<unsigned char>(5000, 'x'));
+    }
+    REQUIRE_FALSE(package::read_summary(file, got));
+
+    unlink_u(file);
+}
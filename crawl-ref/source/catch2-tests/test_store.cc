@@ -0,0 +1,73 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "store.h"
+
+TEST_CASE( "Props keys are found however they are spelt", "[single-file]" ) {
+    CrawlHashTable props;
+    props["literal_key"] = 1;
+    props[string("string_key")] = 2;
+
+    REQUIRE(props.exists("literal_key"));
+    REQUIRE(props.exists(string("literal_key")));
+    REQUIRE(props.exists("string_key"));
+    REQUIRE(props["string_key"].get_int() == 2);
+    REQUIRE_FALSE(props.exists("missing_key"));
+
+    SECTION ("a reused buffer is looked up by what it holds now") {
+        char buf[32];
+        strcpy(buf, "literal_key");
+        REQUIRE(props.exists(buf));
+        strcpy(buf, "string_key");
+        REQUIRE(props[buf].get_int() == 2);
+        strcpy(buf, "missing_key");
+        REQUIRE_FALSE(props.exists(buf));
+    }
+
+    SECTION ("erasing forgets the key whichever way it's done") {
+        REQUIRE(props.erase("literal_key") == 1);
+        REQUIRE_FALSE(props.exists("literal_key"));
+        REQUIRE(props.erase(string("string_key")) == 1);
+        REQUIRE_FALSE(props.exists("string_key"));
+        REQUIRE(props.empty());
+
+        props["literal_key"] = 3;
+        props.erase(props.find("literal_key"));
+        REQUIRE_FALSE(props.exists("literal_key"));
+        REQUIRE(props.erase("literal_key") == 0);
+    }
+
+    SECTION ("copies and swaps look up their own values") {
+        CrawlHashTable copy = props;
+        copy["literal_key"] = 4;
+        REQUIRE(props["literal_key"].get_int() == 1);
+        REQUIRE(copy["literal_key"].get_int() == 4);
+
+        CrawlHashTable other;
+        other["other_key"] = 5;
+        other.swap(props);
+        REQUIRE(props.exists("other_key"));
+        REQUIRE_FALSE(props.exists("literal_key"));
+        REQUIRE(other["literal_key"].get_int() == 1);
+
+        props = copy;
+        REQUIRE_FALSE(props.exists("other_key"));
+        REQUIRE(props["literal_key"].get_int() == 4);
+        props.clear();
+        REQUIRE_FALSE(props.exists("literal_key"));
+    }
+
+    SECTION ("tables read back from a save can be looked up") {
+        vector<unsigned char> buf;
+        writer outf(&buf);
+        props.write(outf);
+
+        CrawlHashTable back;
+        reader inf(buf, TAG_MINOR_VERSION);
+        back.read(inf);
+        REQUIRE(back.size() == 2);
+        REQUIRE(back["literal_key"].get_int() == 1);
+        REQUIRE(back.exists("string_key"));
+    }
+}
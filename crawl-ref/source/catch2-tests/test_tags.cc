@@ -245,3 +245,80 @@ TEST_CASE( "Basic marshalling/unmarshalling works correctly.", "[single-file]" )
         }
     }
 }
+
+// Mixed marshalling, of about the shape of a level: a map_cell, a short
+// and a varint per square, with the odd string and bulk write thrown in.
+static void _marshall_test_level(writer &w, const vector<map_cell> &cells)
+{
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        marshallMapCell(w, cells[i]);
+        marshallShort(w, (short)(i * 7));
+        marshallUnsigned(w, i * i);
+        if (i % 500 == 0)
+            marshallString(w, string(i % 3000, 'x'));
+    }
+    const vector<unsigned char> bulk(MARSHALL_BUFFER_SIZE * 2 + 3, 0x5a);
+    w.write(bulk.data(), bulk.size());
+    marshallInt(w, -1);
+}
+
+// Returns how many values didn't match what _marshall_test_level() wrote.
+static int _unmarshall_test_level(reader &r, const vector<map_cell> &cells)
+{
+    int wrong = 0;
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        map_cell cell;
+        unmarshallMapCell(r, cell);
+        wrong += cell.flags != cells[i].flags;
+        wrong += unmarshallShort(r) != (short)(i * 7);
+        wrong += unmarshallUnsigned(r) != i * i;
+        if (i % 500 == 0)
+            wrong += unmarshallString(r) != string(i % 3000, 'x');
+    }
+    vector<unsigned char> bulk(MARSHALL_BUFFER_SIZE * 2 + 3);
+    r.read(bulk.data(), bulk.size());
+    wrong += bulk != vector<unsigned char>(bulk.size(), 0x5a);
+    wrong += unmarshallInt(r) != -1;
+    return wrong;
+}
+
+static vector<map_cell> _test_level_cells()
+{
+    rng::subgenerator subgen(0, 0);
+    vector<map_cell> cells(GXM * GYM);
+    for (map_cell &cell : cells)
+        cell.flags = rng::get_uint32();
+    return cells;
+}
+
+TEST_CASE( "Save chunks can be roundtripped through the staging buffer",
+           "[single-file]" ) {
+    const vector<map_cell> cells = _test_level_cells();
+
+    package save;
+    {
+        writer w(&save, "lev");
+        _marshall_test_level(w, cells);
+    }
+
+    reader r(&save, "lev", TAG_MINOR_VERSION);
+    REQUIRE(_unmarshall_test_level(r, cells) == 0);
+    REQUIRE_THROWS_AS(unmarshallByte(r), short_read_exception);
+}
+
+TEST_CASE( "Saving and loading a level-sized chunk", "[.][benchmark]" ) {
+    const vector<map_cell> cells = _test_level_cells();
+    package save;
+
+    BENCHMARK("save") {
+        writer w(&save, "lev");
+        _marshall_test_level(w, cells);
+    };
+
+    BENCHMARK("load") {
+        reader r(&save, "lev", TAG_MINOR_VERSION);
+        return _unmarshall_test_level(r, cells);
+    };
+}
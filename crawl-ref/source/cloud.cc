@@ -43,7 +43,7 @@
 
 cloud_struct* cloud_at(coord_def pos)
 {
-    return map_find(env.cloud, pos);
+    return env.cloud.find(pos);
 }
 
 /// damage = base + random2avg(random, random/15 + 1)
@@ -593,15 +593,12 @@ static void _handle_spectral_cloud(const cloud_struct& cloud)
 
 void manage_clouds()
 {
-    // We can't iterate over env.cloud directly because _dissipate_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<cloud_struct *> cloud_ptrs;
-    for (auto& entry : env.cloud)
-        cloud_ptrs.push_back(&entry.second);
-
-    for (auto ptr : cloud_ptrs)
+    // Clouds that spread or appear while this runs wait until next turn.
+    const unsigned int made_before = env.cloud.serial();
+    for (cloud_struct& cloud : env.cloud)
     {
-        cloud_struct& cloud = *ptr;
+        if (env.cloud.made_since(cloud.pos, made_before))
+            continue;
 
 #ifdef ASSERTS
         if (cell_is_solid(cloud.pos))
@@ -663,14 +660,8 @@ void delete_cloud(coord_def p)
 
 void delete_all_clouds()
 {
-    // We can't iterate over env.cloud directly because delete_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<coord_def> cloud_locs;
-    for (auto& entry : env.cloud)
-        cloud_locs.push_back(entry.first);
-
-    for (auto pos : cloud_locs)
-        delete_cloud(pos);
+    for (const cloud_struct& cloud : env.cloud)
+        delete_cloud(cloud.pos);
 }
 
 // The current use of this function is for shifting in the abyss, so
@@ -1750,15 +1741,9 @@ void remove_vortex_clouds(mid_t whose)
     // spell (excluding immobile and mindless casters).
     // XXX: this comment seems impossibly out of date? ^
 
-    // We can't iterate over env.cloud directly because delete_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<coord_def> vortices;
-    for (auto& entry : env.cloud)
-        if (entry.second.type == CLOUD_VORTEX && entry.second.source == whose)
-            vortices.push_back(entry.first);
-
-    for (auto pos : vortices)
-        delete_cloud(pos);
+    for (const cloud_struct& cloud : env.cloud)
+        if (cloud.type == CLOUD_VORTEX && cloud.source == whose)
+            delete_cloud(cloud.pos);
 }
 
 static void _spread_cloud(coord_def pos, cloud_type type, int radius, int pow,
@@ -4674,6 +4674,7 @@ static int _dgn_item_corpse(const item_spec &ispec, const coord_def where)
         if (!mon)
             continue;
         mon->position = where;
+        mon->sync_hot_position();
         corpse = place_monster_corpse(*mon, true);
         // Dismiss the monster we used to place the corpse.
         mon->flags |= MF_HARD_RESET;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <set>
 #include <memory> // unique_ptr
 #include <vector>
@@ -24,6 +25,227 @@ typedef vector<unique_ptr<vault_placement>> vault_placement_refv;
 
 typedef FixedArray< map_cell, GXM, GYM > MapKnowledge;
 
+// The env.mons slots that may hold a monster, so that going through the
+// monsters needn't look at every slot. A slot may be in the set with a dead
+// monster in it, but a live monster's slot is always in it.
+class monster_slot_set
+{
+public:
+    monster_slot_set()
+    {
+        for (uint64_t &word : words)
+            word = 0;
+    }
+
+    void set(int slot, bool in_use)
+    {
+        const uint64_t bit = uint64_t(1) << (slot % 64);
+        if (in_use)
+            words[slot / 64] |= bit;
+        else
+            words[slot / 64] &= ~bit;
+    }
+
+    // The first slot from 'slot' on that may hold a monster, or
+    // MAX_MONSTERS if there are none.
+    int next(int slot) const
+    {
+        for (int w = slot / 64; w < NUM_WORDS; ++w)
+        {
+            uint64_t word = words[w];
+            if (w == slot / 64)
+                word &= ~uint64_t(0) << (slot % 64);
+            if (!word)
+                continue;
+#ifdef __GNUC__
+            return min(w * 64 + __builtin_ctzll(word), (int) MAX_MONSTERS);
+#else
+            int bit = 0;
+            while (!(word & 1))
+                word >>= 1, ++bit;
+            return min(w * 64 + bit, (int) MAX_MONSTERS);
+#endif
+        }
+        return MAX_MONSTERS;
+    }
+
+private:
+    static const int NUM_WORDS = (MAX_MONSTERS + 63) / 64;
+    uint64_t words[NUM_WORDS];
+};
+
+// The clouds on the level. Each cloud lives in a slot, and each cell holds
+// the number of its cloud's slot (plus one), so finding the cloud in a
+// cell is a single lookup. Slots of clouds that are gone are reused, and a
+// cloud never moves between slots while it exists, so references to it
+// stay good until it's erased. Iteration goes by position, in the same
+// order as a map<coord_def, cloud_struct> would, and carries on safely if
+// clouds are erased along the way.
+class cloud_grid
+{
+public:
+    class iterator
+    {
+    public:
+        iterator(cloud_grid &g, const coord_def &p) : grid(g), pos(p)
+        {
+            skip();
+        }
+
+        cloud_struct& operator*() const { return *grid.find(pos); }
+        cloud_struct* operator->() const { return grid.find(pos); }
+
+        iterator& operator++()
+        {
+            advance();
+            skip();
+            return *this;
+        }
+
+        bool operator!=(const iterator &other) const
+        {
+            return pos != other.pos;
+        }
+
+    private:
+        void advance()
+        {
+            if (++pos.y == GYM)
+                pos.y = 0, ++pos.x;
+        }
+
+        void skip()
+        {
+            while (pos.x < GXM && !grid.index(pos))
+                advance();
+        }
+
+        cloud_grid &grid;
+        coord_def pos;
+    };
+
+    cloud_grid() : next_serial(0)
+    {
+        index.init(0);
+    }
+
+    cloud_struct* find(const coord_def &p)
+    {
+        const uint16_t i = index(p);
+        return i ? &slots[i - 1] : nullptr;
+    }
+
+    // The cloud at p, made (empty) if there isn't one.
+    cloud_struct& operator[](const coord_def &p)
+    {
+        if (const uint16_t i = index(p))
+            return slots[i - 1];
+
+        int slot;
+        if (free_slots.empty())
+        {
+            slot = slots.size();
+            slots.emplace_back();
+        }
+        else
+        {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            slots[slot] = cloud_struct();
+        }
+        index(p) = slot + 1;
+        made(p) = next_serial++;
+        return slots[slot];
+    }
+
+    void erase(const coord_def &p)
+    {
+        const uint16_t i = index(p);
+        if (!i)
+            return;
+        slots[i - 1] = cloud_struct();
+        free_slots.push_back(i - 1);
+        index(p) = 0;
+    }
+
+    void clear()
+    {
+        index.init(0);
+        slots.clear();
+        free_slots.clear();
+    }
+
+    int size() const { return slots.size() - free_slots.size(); }
+
+    // For telling apart the clouds made after this call...
+    unsigned int serial() const { return next_serial; }
+    // ... by passing what it returned here.
+    bool made_since(const coord_def &p, unsigned int mark) const
+    {
+        return index(p) && made(p) >= mark;
+    }
+
+    // Puts the clouds in some cells back as they were (made serial and all)
+    // when it goes out of scope, for trying out changes that may wipe them
+    // without copying the whole grid.
+    class saved_cells
+    {
+    public:
+        saved_cells(cloud_grid &g, const set<coord_def> &cells) : grid(g)
+        {
+            for (const coord_def &p : cells)
+            {
+                const cloud_struct *cloud = grid.find(p);
+                saved.push_back({p, cloud != nullptr,
+                                 cloud ? *cloud : cloud_struct(),
+                                 grid.made(p)});
+            }
+        }
+
+        ~saved_cells()
+        {
+            for (const cell &c : saved)
+            {
+                if (!c.had_cloud)
+                {
+                    grid.erase(c.pos);
+                    continue;
+                }
+                grid[c.pos] = c.cloud;
+                grid.made(c.pos) = c.made;
+            }
+        }
+
+        saved_cells(const saved_cells &) = delete;
+        saved_cells& operator=(const saved_cells &) = delete;
+
+    private:
+        struct cell
+        {
+            coord_def pos;
+            bool had_cloud;
+            cloud_struct cloud;
+            unsigned int made;
+        };
+
+        cloud_grid &grid;
+        vector<cell> saved;
+    };
+
+    iterator begin()
+    {
+        return iterator(*this, size() ? coord_def(0, 0) : coord_def(GXM, 0));
+    }
+    iterator end() { return iterator(*this, coord_def(GXM, 0)); }
+
+private:
+    FixedArray<uint16_t, GXM, GYM> index;
+    FixedArray<unsigned int, GXM, GYM> made;
+    deque<cloud_struct> slots;
+    vector<uint16_t> free_slots;
+    unsigned int next_serial;
+};
+
 class final_effect;
 struct crawl_environment
 {
@@ -31,6 +253,12 @@ struct crawl_environment
     colour_t floor_colour;
 
     FixedVector< item_def, MAX_ITEMS >       item;  // item list
+    // Not marshalled: which env.mons slots are used, and where each
+    // monster is, so scans over the monsters can skip most of them without
+    // touching the monster objects. These come before mons, as constructing
+    // a monster already updates them.
+    monster_slot_set                         mons_in_use;
+    FixedVector< coord_def, MAX_MONSTERS >   mons_pos;
     FixedVector< monster, MAX_MONSTERS+2 >   mons;  // monster list, plus anon
 
     feature_grid                             grid;  // terrain grid
@@ -61,7 +289,7 @@ struct crawl_environment
 
     vector<coord_def>                        travel_trail;
 
-    map<coord_def, cloud_struct> cloud;
+    cloud_grid cloud;
 
     map<coord_def, shop_struct> shop; // shop list
     map<coord_def, trap_def> trap; // trap list
@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <sstream>
+#include <typeindex>
+#include <typeinfo>
 
 #include "cloud.h"
 #include "coord.h"
@@ -218,6 +220,19 @@ void exclude_set::add_exclude(const coord_def &p, int radius,
 }
 
 void exclude_set::add_exclude_points(travel_exclude& ex)
+{
+    if (ex.radius != 0)
+    {
+        if (!ex.uptodate)
+            ex.set_los();
+        else
+            ex.los.update();
+    }
+
+    insert_exclude_points(ex);
+}
+
+void exclude_set::insert_exclude_points(const travel_exclude& ex)
 {
     if (ex.radius == 0)
     {
@@ -225,11 +240,6 @@ void exclude_set::add_exclude_points(travel_exclude& ex)
         return;
     }
 
-    if (!ex.uptodate)
-        ex.set_los();
-    else
-        ex.los.update();
-
     for (radius_iterator ri(ex.pos, ex.radius, C_SQUARE); ri; ++ri)
         if (ex.affects(*ri))
             exclude_points.insert(*ri);
@@ -250,14 +260,27 @@ void exclude_set::update_excluded_points(bool recompute_los)
 
 void exclude_set::recompute_excluded_points(bool recompute_los)
 {
-    exclude_points.clear();
+    // Redo the LOS of all exclusions in one go, batched by opacity.
+    // Exclusions only use stateless opacity functions, so any two of
+    // the same type agree.
+    map<type_index, vector<los_def*>> batches;
     for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
     {
         travel_exclude &ex = it->second;
-        if (recompute_los)
-            ex.set_los();
-        add_exclude_points(ex);
+        if (recompute_los || !ex.uptodate)
+        {
+            ex.uptodate = true;
+            ex.los.set_bounds(circle_def(ex.radius, C_SQUARE));
+        }
+        if (ex.radius > 1)
+            batches[typeid(ex.los.get_opacity())].push_back(&ex.los);
     }
+    for (const auto &batch : batches)
+        los_def::update_many(batch.second);
+
+    exclude_points.clear();
+    for (iterator it = exclude_roots.begin(); it != exclude_roots.end(); ++it)
+        insert_exclude_points(it->second);
 }
 
 bool exclude_set::is_excluded(const coord_def &p) const
@@ -94,6 +94,7 @@ private:
 
 private:
     void add_exclude_points(travel_exclude& ex);
+    void insert_exclude_points(const travel_exclude& ex);
 };
 
 extern exclude_set curr_excludes; // in travel.cc
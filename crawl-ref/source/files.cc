@@ -139,6 +139,8 @@ static bool _ghost_version_compatible(const save_version &version);
 static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint);
 static player_save_info _read_character_info(package *save);
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename);
 
 static bool _convert_obsolete_species();
 
@@ -705,7 +707,8 @@ static bool _readln(chunk_reader &rd, char *buf)
     return true;
 }
 
-static void _fill_player_doll(player_save_info &p, package *save)
+// parts is a line as written by save_doll_file(), or null if there is none.
+static void _fill_player_doll(player_save_info &p, char *parts)
 {
     dolls_data equip_doll;
     for (unsigned int j = 0; j < TILEP_PART_MAX; ++j)
@@ -716,15 +719,11 @@ static void _fill_player_doll(player_save_info &p, package *save)
 
     bool success = false;
 
-    chunk_reader fdoll(save, "tdl");
+    if (parts)
     {
-        char fbuf[LINEMAX];
-        if (_readln(fdoll,fbuf))
-        {
-            tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
-            tilep_race_default(p.species, p.experience_level, &equip_doll);
-            success = true;
-        }
+        tilep_scan_parts(parts, equip_doll, p.species, p.experience_level);
+        tilep_race_default(p.species, p.experience_level, &equip_doll);
+        success = true;
     }
 
     if (!success) // Use default doll instead.
@@ -737,7 +736,123 @@ static void _fill_player_doll(player_save_info &p, package *save)
     }
     p.doll = equip_doll;
 }
+
+static void _fill_player_doll(player_save_info &p, package *save)
+{
+    chunk_reader fdoll(save, "tdl");
+    char fbuf[LINEMAX];
+    _fill_player_doll(p, _readln(fdoll, fbuf) ? fbuf : nullptr);
+}
+#endif
+
+// Bump when changing what save_summary() writes; a summary in any other
+// format is ignored, and the save's chunks are read instead.
+#define SAVE_SUMMARY_FORMAT 1
+
+/*
+ * What the list of saved games shows about this character: the "chr" chunk
+ * and the tile doll, written together for package::set_summary().
+ */
+vector<unsigned char> save_summary()
+{
+    vector<unsigned char> chr;
+    {
+        writer outf(&chr);
+        write_save_version(outf, save_version::current());
+        tag_write(TAG_CHR, outf);
+    }
+
+    string doll;
+#ifdef USE_TILE
+    vector<unsigned char> dollbuf;
+    {
+        writer dollf(&dollbuf);
+        save_doll_file(dollf);
+    }
+    doll.assign(dollbuf.begin(), dollbuf.end());
+#endif
+
+    vector<unsigned char> summary;
+    writer outf(&summary);
+    marshallUByte(outf, SAVE_SUMMARY_FORMAT);
+    marshallString(outf, string(chr.begin(), chr.end()));
+    marshallString(outf, doll);
+    return summary;
+}
+
+/*
+ * Character info from a save summary made by save_summary(). Returns false
+ * if the summary is in a format this build doesn't know, and throws if it
+ * is damaged.
+ */
+static bool _read_summary_info(const vector<unsigned char> &summary,
+                               const string &path, bool doll,
+                               player_save_info &p)
+{
+    reader inf(summary);
+    inf.set_safe_read(true);
+    if (unmarshallUByte(inf) != SAVE_SUMMARY_FORMAT)
+        return false;
+
+    const string chr = unmarshallString(inf);
+    const string parts = unmarshallString(inf);
+    vector<unsigned char> chrbuf(chr.begin(), chr.end());
+    reader chrinf(chrbuf);
+    chrinf.set_safe_read(true);
+    p = _read_character_info(chrinf, path);
+#ifdef USE_TILE
+    if (doll && !p.name.empty())
+    {
+        // Written by another build, perhaps a console one.
+        char fbuf[LINEMAX];
+        const size_t len = min<size_t>(parts.size(), LINEMAX - 1);
+        memcpy(fbuf, parts.data(), len);
+        fbuf[len] = 0;
+        _fill_player_doll(p, len ? fbuf : nullptr);
+    }
+#else
+    UNUSED(doll, parts);
+#endif
+    return true;
+}
+
+/*
+ * Character info for the save at path, taken from the summary in its header
+ * if it has one (which takes a single small read), and otherwise from the
+ * chunks in the package.
+ */
+player_save_info read_save_info(const string &path, bool doll)
+{
+    vector<unsigned char> summary;
+    if (package::read_summary(path.c_str(), summary))
+    {
+        try
+        {
+            player_save_info p;
+            if (_read_summary_info(summary, path, doll, p))
+                return p;
+        }
+        catch (short_read_exception &E)
+        {
+            dprf("Bad save summary in %s, reading the package", path.c_str());
+        }
+        catch (ext_fail_exception &E)
+        {
+            dprf("Bad save summary in %s (%s), reading the package",
+                 path.c_str(), E.what());
+        }
+    }
+
+    package save(path.c_str(), false);
+    player_save_info p = _read_character_info(&save);
+#ifdef USE_TILE
+    if (doll && !p.name.empty() && save.has_chunk("tdl"))
+        _fill_player_doll(p, &save);
+#else
+    UNUSED(doll);
 #endif
+    return p;
+}
 
 /*
  * Returns a list of the names of characters that are already saved for the
@@ -763,15 +878,16 @@ static vector<player_save_info> _find_saved_characters()
         {
             try
             {
-                package save(_get_savedir_path(filename).c_str(), false);
-                player_save_info p = _read_character_info(&save);
+#ifdef USE_TILE
+                const bool doll = Options.tile_menu_icons;
+#else
+                const bool doll = false;
+#endif
+                player_save_info p
+                    = read_save_info(_get_savedir_path(filename), doll);
                 if (!p.name.empty())
                 {
                     p.filename = filename;
-#ifdef USE_TILE
-                    if (Options.tile_menu_icons && save.has_chunk("tdl"))
-                        _fill_player_doll(p, &save);
-#endif
                     chars.push_back(p);
                 }
             }
@@ -860,8 +976,7 @@ static bool _append_save_info(JsonWrapper &json, const char *filename,
         return false;
     try
     {
-        package save(filename, false);
-        player_save_info p = _read_character_info(&save);
+        player_save_info p = read_save_info(filename, false);
 
         // TODO: some json for the non-loadable case? I think this comes up
         // for save compat mismatches so shouldn't be relevant for webtiles
@@ -1322,15 +1437,13 @@ static void _grab_followers()
     }
 
     // Clear flags of monsters that didn't follow.
-    for (auto &mons : menv_real)
+    for (monster_iterator mi; mi; ++mi)
     {
-        if (!mons.alive())
-            continue;
-        if (mons.type == MONS_BATTLESPHERE)
-            end_battlesphere(&mons, false);
-        if (mons.type == MONS_SPECTRAL_WEAPON)
-            end_spectral_weapon(&mons, false);
-        mons.flags &= ~MF_TAKING_STAIRS;
+        if (mi->type == MONS_BATTLESPHERE)
+            end_battlesphere(*mi, false);
+        if (mi->type == MONS_SPECTRAL_WEAPON)
+            end_spectral_weapon(*mi, false);
+        mi->flags &= ~MF_TAKING_STAIRS;
     }
 }
 
@@ -2530,6 +2643,8 @@ static void _save_game_base()
 
     _write_tagged_chunk("you", TAG_YOU);
     _write_tagged_chunk("chr", TAG_CHR);
+
+    you.save->set_summary(save_summary());
 }
 
 // Stack allocated string's go in separate function, so Valgrind doesn't
@@ -2555,6 +2670,9 @@ static void _save_game_exit()
     tiles.send_exit_reason("saved");
 #endif
 
+    // Any error from a background commit is reported here; the package
+    // can't do that once it's being deleted.
+    you.save->sync();
     delete you.save;
     you.save = 0;
 }
@@ -3133,6 +3251,8 @@ static bool _restore_game(const string& filename)
     clear_message_store();
 
     you.save = new package((_get_savefile_directory() + filename).c_str(), true);
+    you.save->set_codec(Options.save_compression);
+    you.save->set_background(Options.background_save);
 
     player_save_info save_info = _read_character_info(you.save);
     if (!save_info.save_loadable)
@@ -3491,7 +3611,12 @@ static bool _loadable_save_ver(int major, int minor)
 static player_save_info _read_character_info(package *save)
 {
     reader inf(save, "chr");
+    return _read_character_info(inf, save->get_filename());
+}
 
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename)
+{
     try
     {
         player_save_info result;
@@ -3501,7 +3626,7 @@ static player_save_info _read_character_info(package *save)
 
         unsigned int len = unmarshallInt(inf);
         if (len > 1024) // something is fishy
-            fail("Save file `%s` corrupted (info > 1KB)", save->get_filename().c_str());
+            fail("Save file `%s` corrupted (info > 1KB)", filename.c_str());
         vector<unsigned char> buf;
         buf.resize(len);
         inf.read(&buf[0], len);
@@ -3517,7 +3642,7 @@ static player_save_info _read_character_info(package *save)
         if (format > TAG_CHR_FORMAT)
         {
             fail("Incompatible character data from the future in `%s`",
-                                        save->get_filename().c_str());
+                                        filename.c_str());
         }
 
         result = tag_read_char_info(th, format, major, minor);
@@ -3532,7 +3657,7 @@ static player_save_info _read_character_info(package *save)
     }
     catch (short_read_exception &E)
     {
-        fail("Save file `%s` corrupted (short read)", save->get_filename().c_str());
+        fail("Save file `%s` corrupted (short read)", filename.c_str());
     };
 }
 
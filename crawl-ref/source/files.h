@@ -71,6 +71,12 @@ bool check_mkdir(const string &what, string *dir, bool silent = false);
 // Find saved games for all game types.
 vector<player_save_info> find_all_saved_characters();
 
+// What the saved game list shows about the current character, as kept in
+// the save header; and reading that back (or the chunks, if the summary is
+// missing or damaged) for the save at path.
+vector<unsigned char> save_summary();
+player_save_info read_save_info(const string &path, bool doll);
+
 NORETURN void print_save_json(const char *name);
 
 string get_save_filename(const string &name);
@@ -531,6 +531,14 @@ const vector<GameOption*> game_options::build_options_list()
             [this]() { update_travel_terrain(); }),
         new BoolGameOption(SIMPLE_NAME(travel_one_unsafe_move), false),
         new BoolGameOption(SIMPLE_NAME(dump_on_save), true),
+        new MultipleChoiceGameOption<save_codec>(
+            SIMPLE_NAME(save_compression),
+            save_codec::zlib,
+            {{"zlib", save_codec::zlib},
+             {"none", save_codec::none},
+             {"zstd", save_codec::zstd},
+             {"lz4", save_codec::lz4}}),
+        new BoolGameOption(SIMPLE_NAME(background_save), false),
         new BoolGameOption(SIMPLE_NAME(rest_wait_both), false),
         new BoolGameOption(SIMPLE_NAME(rest_wait_ancestor), false),
         new BoolGameOption(SIMPLE_NAME(cloud_status), !is_tiles()),
@@ -557,6 +565,7 @@ const vector<GameOption*> game_options::build_options_list()
         new BoolGameOption(SIMPLE_NAME(arena_dump_msgs), false),
         new BoolGameOption(SIMPLE_NAME(arena_dump_msgs_all), false),
         new BoolGameOption(SIMPLE_NAME(arena_list_eq), false),
+        new IntGameOption(SIMPLE_NAME(los_prefetch_threads), 1, 1, 64),
         new BoolGameOption(SIMPLE_NAME(default_manual_training), false),
         new BoolGameOption(SIMPLE_NAME(one_SDL_sound_channel), false),
         new BoolGameOption(SIMPLE_NAME(sounds_on), true),
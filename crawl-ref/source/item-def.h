@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <memory>
+
+#include "artefact-prop-type.h"
 #include "description-level-type.h"
 #include "level-id.h"
 #include "monster-type.h"
@@ -18,6 +21,52 @@
 // extend this in the future, so this should be easier than undoing the change.
 typedef uint32_t iflags_t;
 
+/// The property values of an artefact, one short per artefact_prop_type.
+/// Empty for items that aren't artefacts (or whose properties haven't been
+/// set up yet), so as to cost them only a pointer. Saves still keep these
+/// in the item's props, as ARTEFACT_PROPS_KEY.
+class artefact_prop_block
+{
+public:
+    artefact_prop_block() { }
+    artefact_prop_block(const artefact_prop_block &other)
+    {
+        *this = other;
+    }
+
+    artefact_prop_block& operator=(const artefact_prop_block &other)
+    {
+        if (!other.vals)
+            vals.reset();
+        else if (this != &other)
+        {
+            init();
+            for (int i = 0; i < ARTP_NUM_PROPERTIES; i++)
+                vals[i] = other.vals[i];
+        }
+        return *this;
+    }
+
+    explicit operator bool() const { return bool(vals); }
+
+    /// Make the block if there isn't one yet, and zero it.
+    void init()
+    {
+        if (!vals)
+            vals.reset(new short[ARTP_NUM_PROPERTIES]);
+        for (int i = 0; i < ARTP_NUM_PROPERTIES; i++)
+            vals[i] = 0;
+    }
+
+    void reset() { vals.reset(); }
+
+    short operator[](int prop) const { return vals[prop]; }
+    short& operator[](int prop) { return vals[prop]; }
+
+private:
+    unique_ptr<short[]> vals;
+};
+
 struct item_def
 {
     object_class_type base_type; ///< basic class (eg OBJ_WEAPON)
@@ -81,6 +130,9 @@ struct item_def
 
     CrawlHashTable props;
 
+    /// Artefact property values; see artefact_property().
+    artefact_prop_block art_props;
+
 public:
     item_def() : base_type(OBJ_UNASSIGNED), sub_type(0), plus(0), plus2(0),
                  special(0), rnd(0), quantity(0), flags(0),
@@ -392,6 +392,7 @@ bool dec_inv_item_quantity(int obj, int amount)
                     canned_msg(MSG_EMPTY_HANDED_NOW);
                 }
                 you.equip[i] = -1;
+                you.invalidate_artefact_totals();
             }
         }
 
@@ -400,6 +401,7 @@ bool dec_inv_item_quantity(int obj, int amount)
         you.inv[obj].base_type = OBJ_UNASSIGNED;
         you.inv[obj].quantity  = 0;
         you.inv[obj].props.clear();
+        you.inv[obj].art_props.reset();
 
         ret = true;
 
@@ -601,6 +603,7 @@ void unlink_item(int dest)
     env.item[dest].link      = NON_ITEM;
     env.item[dest].pos.reset();
     env.item[dest].props.clear();
+    env.item[dest].art_props.reset();
 
     // Look through all items for links to this item.
     for (auto &item : env.item)
@@ -4637,21 +4640,19 @@ item_def get_item_known_info(const item_def& item)
         if (item.props.exists(prop))
             ii.props[prop] = item.props[prop];
 
-    if (item.props.exists(ARTEFACT_PROPS_KEY))
+    if (item.art_props)
     {
-        CrawlVector props = item.props[ARTEFACT_PROPS_KEY].get_vector();
+        ii.art_props = item.art_props;
         const CrawlVector &known = item.props[KNOWN_PROPS_KEY].get_vector();
 
         if (!item_ident(item, ISFLAG_KNOW_PROPERTIES))
         {
-            for (unsigned i = 0; i < props.size(); ++i)
+            for (unsigned i = 0; i < ART_PROPERTIES; ++i)
             {
                 if (i >= known.size() || !known[i].get_bool())
-                    props[i] = (short)0;
+                    ii.art_props[i] = 0;
             }
         }
-
-        ii.props[ARTEFACT_PROPS_KEY] = props;
     }
 
     return ii;
@@ -7,6 +7,8 @@
 
 #include "los-def.h"
 
+#include "coordit.h"
+
 
 los_def::los_def()
     : show(0), opc(opc_default.clone()), bds(BDS_DEFAULT)
@@ -54,6 +56,31 @@ void los_def::update()
     losight(show, center, *opc, bds);
 }
 
+void los_def::update_many(const vector<los_def*>& defs)
+{
+    if (defs.empty())
+        return;
+
+    vector<coord_def> centers;
+    for (const los_def* def : defs)
+        centers.push_back(def->center);
+
+    // Cells on the way to a target are never further away than the
+    // target, so LOS within the full square cut down to each def's
+    // bounds is the same as LOS computed with those bounds.
+    vector<los_grid> grids;
+    losight_many(grids, centers, *defs[0]->opc,
+                 circle_def(LOS_MAX_RANGE, C_SQUARE));
+    for (size_t i = 0; i < defs.size(); ++i)
+    {
+        los_def &def = *defs[i];
+        def.show = grids[i];
+        for (rectangle_iterator ri(coord_def(0, 0), LOS_MAX_RANGE); ri; ++ri)
+            if (!def.bds.contains(*ri))
+                def.show(*ri) = false;
+    }
+}
+
 void los_def::set_center(const coord_def& c)
 {
     center = c;
@@ -75,6 +102,11 @@ void los_def::set_bounds(const circle_def &b)
     bds = b;
 }
 
+const opacity_func& los_def::get_opacity() const
+{
+    return *opc;
+}
+
 circle_def los_def::get_bounds() const
 {
     return circle_def(center, bds);
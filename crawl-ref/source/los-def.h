@@ -21,10 +21,14 @@ public:
     void set_center(const coord_def& center);
     coord_def get_center() const;
     void set_opacity(const opacity_func& o);
+    const opacity_func& get_opacity() const;
     void set_bounds(const circle_def& b);
     circle_def get_bounds() const;
 
     void update();
+    // Update several los_defs in one batch. They must all have
+    // opacity functions that agree with the first one's.
+    static void update_many(const vector<los_def*>& defs);
     bool in_bounds(const coord_def& p) const;
     bool see_cell(const coord_def& p) const;
 };
@@ -0,0 +1,764 @@
+// Generated by util/gen-los-tables.cc; do not edit.
+// Regenerate with "make los-tables" after changing LOS_MAX_RANGE
+// or the ray geometry in ray.cc and geom2d.cc.
+//
+// Cellrays: 1208 Fullrays: 151 Minimal cellrays: 428
+
+#pragma once
+
+#if LOS_MAX_RANGE != 8
+# error "los-tables.h is out of date; run 'make los-tables'"
+#endif
+
+// A fullray: its starting point and direction, and where its
+// footprint is stored in los_ray_coords.
+struct los_table_ray
+{
+    double start_x, start_y, dir_x, dir_y;
+    unsigned short start;
+    unsigned short length;
+};
+
+// A minimal cellray, given by its fullray and the relative index
+// of its end cell inside that ray.
+struct los_table_cellray
+{
+    unsigned short ray;
+    unsigned short end;
+};
+
+typedef uint64_t los_mask_word;
+#define LOS_MASK_WORD_BITS 64
+#define LOS_MASK_ALIGN 64
+
+#define LOS_NUM_FULLRAYS 151
+#define LOS_NUM_RAY_COORDS 1208
+#define LOS_NUM_CELLRAYS 428
+#define LOS_MASK_WORDS 8
+
+static const los_table_ray los_fullrays[LOS_NUM_FULLRAYS] =
+{
+    { 0.5, 0.5, 0, 1, 0, 8 },
+    { 0.5, 0.5, 1, 0, 8, 8 },
+    { 0.5, 0.5, 1, 1, 16, 8 },
+    { 0.25, 0.5, 1, 2, 24, 8 },
+    { 0.5, 0.25, 2, 1, 32, 8 },
+    { 0.75, 0.5, 1, 2, 40, 8 },
+    { 0.5, 0.75, 2, 1, 48, 8 },
+    { 0.16666666666666666, 0.5, 1, 3, 56, 8 },
+    { 0.5, 0.16666666666666666, 3, 1, 64, 8 },
+    { 0.5, 0.5, 1, 3, 72, 8 },
+    { 0.5, 0.5, 3, 1, 80, 8 },
+    { 0.83333333333333337, 0.5, 1, 3, 88, 8 },
+    { 0.5, 0.83333333333333337, 3, 1, 96, 8 },
+    { 0.125, 0.5, 1, 4, 104, 8 },
+    { 0.5, 0.125, 4, 1, 112, 8 },
+    { 0.375, 0.5, 1, 4, 120, 8 },
+    { 0.5, 0.375, 4, 1, 128, 8 },
+    { 0.625, 0.5, 1, 4, 136, 8 },
+    { 0.5, 0.625, 4, 1, 144, 8 },
+    { 0.875, 0.5, 1, 4, 152, 8 },
+    { 0.5, 0.875, 4, 1, 160, 8 },
+    { 0.5, 0.5, 5, 1, 168, 8 },
+    { 0.5, 0.5, 1, 5, 176, 8 },
+    { 0.10000000000000001, 0.5, 1, 5, 184, 8 },
+    { 0.5, 0.10000000000000001, 5, 1, 192, 8 },
+    { 0.29999999999999999, 0.5, 1, 5, 200, 8 },
+    { 0.5, 0.29999999999999999, 5, 1, 208, 8 },
+    { 0.69999999999999996, 0.5, 1, 5, 216, 8 },
+    { 0.5, 0.69999999999999996, 5, 1, 224, 8 },
+    { 0.90000000000000002, 0.5, 1, 5, 232, 8 },
+    { 0.5, 0.90000000000000002, 5, 1, 240, 8 },
+    { 0.5, 0.5, 3, 2, 248, 8 },
+    { 0.5, 0.5, 2, 3, 256, 8 },
+    { 0.083333333333333329, 0.5, 1, 6, 264, 8 },
+    { 0.5, 0.083333333333333329, 6, 1, 272, 8 },
+    { 0.58333333333333337, 0.5, 1, 6, 280, 8 },
+    { 0.5, 0.58333333333333337, 6, 1, 288, 8 },
+    { 0.75, 0.5, 1, 6, 296, 8 },
+    { 0.5, 0.75, 6, 1, 304, 8 },
+    { 0.91666666666666663, 0.5, 1, 6, 312, 8 },
+    { 0.5, 0.91666666666666663, 6, 1, 320, 8 },
+    { 0.16666666666666666, 0.5, 2, 3, 328, 8 },
+    { 0.5, 0.16666666666666666, 3, 2, 336, 8 },
+    { 0.83333333333333337, 0.5, 2, 3, 344, 8 },
+    { 0.5, 0.83333333333333337, 3, 2, 352, 8 },
+    { 0.071428571428571425, 0.5, 1, 7, 360, 8 },
+    { 0.5, 0.071428571428571425, 7, 1, 368, 8 },
+    { 0.7857142857142857, 0.5, 1, 7, 376, 8 },
+    { 0.5, 0.7857142857142857, 7, 1, 384, 8 },
+    { 0.9285714285714286, 0.5, 1, 7, 392, 8 },
+    { 0.5, 0.9285714285714286, 7, 1, 400, 8 },
+    { 0.0625, 0.5, 1, 8, 408, 8 },
+    { 0.5, 0.0625, 8, 1, 416, 8 },
+    { 0.9375, 0.5, 1, 8, 424, 8 },
+    { 0.5, 0.9375, 8, 1, 432, 8 },
+    { 0.10000000000000001, 0.5, 2, 5, 440, 8 },
+    { 0.5, 0.10000000000000001, 5, 2, 448, 8 },
+    { 0.29999999999999999, 0.5, 2, 5, 456, 8 },
+    { 0.5, 0.29999999999999999, 5, 2, 464, 8 },
+    { 0.5, 0.5, 2, 5, 472, 8 },
+    { 0.5, 0.5, 5, 2, 480, 8 },
+    { 0.69999999999999996, 0.5, 2, 5, 488, 8 },
+    { 0.5, 0.69999999999999996, 5, 2, 496, 8 },
+    { 0.90000000000000002, 0.5, 2, 5, 504, 8 },
+    { 0.5, 0.90000000000000002, 5, 2, 512, 8 },
+    { 0.125, 0.5, 3, 4, 520, 8 },
+    { 0.5, 0.125, 4, 3, 528, 8 },
+    { 0.375, 0.5, 3, 4, 536, 8 },
+    { 0.5, 0.375, 4, 3, 544, 8 },
+    { 0.625, 0.5, 3, 4, 552, 8 },
+    { 0.5, 0.625, 4, 3, 560, 8 },
+    { 0.875, 0.5, 3, 4, 568, 8 },
+    { 0.5, 0.875, 4, 3, 576, 8 },
+    { 0.071428571428571425, 0.5, 2, 7, 584, 8 },
+    { 0.5, 0.071428571428571425, 7, 2, 592, 8 },
+    { 0.6428571428571429, 0.5, 2, 7, 600, 8 },
+    { 0.5, 0.6428571428571429, 7, 2, 608, 8 },
+    { 0.7857142857142857, 0.5, 2, 7, 616, 8 },
+    { 0.5, 0.7857142857142857, 7, 2, 624, 8 },
+    { 0.9285714285714286, 0.5, 2, 7, 632, 8 },
+    { 0.5, 0.9285714285714286, 7, 2, 640, 8 },
+    { 0.10000000000000001, 0.5, 3, 5, 648, 8 },
+    { 0.5, 0.10000000000000001, 5, 3, 656, 8 },
+    { 0.29999999999999999, 0.5, 3, 5, 664, 8 },
+    { 0.5, 0.29999999999999999, 5, 3, 672, 8 },
+    { 0.5, 0.5, 3, 5, 680, 8 },
+    { 0.5, 0.5, 5, 3, 688, 8 },
+    { 0.69999999999999996, 0.5, 3, 5, 696, 8 },
+    { 0.5, 0.69999999999999996, 5, 3, 704, 8 },
+    { 0.90000000000000002, 0.5, 3, 5, 712, 8 },
+    { 0.5, 0.90000000000000002, 5, 3, 720, 8 },
+    { 0.10000000000000001, 0.5, 4, 5, 728, 8 },
+    { 0.5, 0.10000000000000001, 5, 4, 736, 8 },
+    { 0.29999999999999999, 0.5, 4, 5, 744, 8 },
+    { 0.5, 0.29999999999999999, 5, 4, 752, 8 },
+    { 0.5, 0.5, 4, 5, 760, 8 },
+    { 0.5, 0.5, 5, 4, 768, 8 },
+    { 0.69999999999999996, 0.5, 4, 5, 776, 8 },
+    { 0.5, 0.69999999999999996, 5, 4, 784, 8 },
+    { 0.90000000000000002, 0.5, 4, 5, 792, 8 },
+    { 0.5, 0.90000000000000002, 5, 4, 800, 8 },
+    { 0.16666666666666666, 0.5, 7, 3, 808, 8 },
+    { 0.5, 0.16666666666666666, 3, 7, 816, 8 },
+    { 0.5, 0.5, 7, 3, 824, 8 },
+    { 0.5, 0.5, 3, 7, 832, 8 },
+    { 0.071428571428571425, 0.5, 3, 7, 840, 8 },
+    { 0.5, 0.071428571428571425, 7, 3, 848, 8 },
+    { 0.9285714285714286, 0.5, 3, 7, 856, 8 },
+    { 0.5, 0.9285714285714286, 7, 3, 864, 8 },
+    { 0.0625, 0.5, 3, 8, 872, 8 },
+    { 0.5, 0.0625, 8, 3, 880, 8 },
+    { 0.9375, 0.5, 3, 8, 888, 8 },
+    { 0.5, 0.9375, 8, 3, 896, 8 },
+    { 0.5, 0.5, 7, 4, 904, 8 },
+    { 0.5, 0.5, 4, 7, 912, 8 },
+    { 0.75, 0.5, 7, 4, 920, 8 },
+    { 0.5, 0.75, 4, 7, 928, 8 },
+    { 0.071428571428571425, 0.5, 4, 7, 936, 8 },
+    { 0.5, 0.071428571428571425, 7, 4, 944, 8 },
+    { 0.9285714285714286, 0.5, 4, 7, 952, 8 },
+    { 0.5, 0.9285714285714286, 7, 4, 960, 8 },
+    { 0.083333333333333329, 0.5, 5, 6, 968, 8 },
+    { 0.5, 0.083333333333333329, 6, 5, 976, 8 },
+    { 0.25, 0.5, 5, 6, 984, 8 },
+    { 0.5, 0.25, 6, 5, 992, 8 },
+    { 0.41666666666666669, 0.5, 5, 6, 1000, 8 },
+    { 0.5, 0.41666666666666669, 6, 5, 1008, 8 },
+    { 0.91666666666666663, 0.5, 5, 6, 1016, 8 },
+    { 0.5, 0.91666666666666663, 6, 5, 1024, 8 },
+    { 0.69999999999999996, 0.5, 7, 5, 1032, 8 },
+    { 0.5, 0.69999999999999996, 5, 7, 1040, 8 },
+    { 0.90000000000000002, 0.5, 7, 5, 1048, 8 },
+    { 0.5, 0.90000000000000002, 5, 7, 1056, 8 },
+    { 0.071428571428571425, 0.5, 5, 7, 1064, 8 },
+    { 0.5, 0.071428571428571425, 7, 5, 1072, 8 },
+    { 0.9285714285714286, 0.5, 5, 7, 1080, 8 },
+    { 0.5, 0.9285714285714286, 7, 5, 1088, 8 },
+    { 0.0625, 0.5, 5, 8, 1096, 8 },
+    { 0.5, 0.0625, 8, 5, 1104, 8 },
+    { 0.9375, 0.5, 5, 8, 1112, 8 },
+    { 0.5, 0.9375, 8, 5, 1120, 8 },
+    { 0.83333333333333337, 0.5, 7, 6, 1128, 8 },
+    { 0.5, 0.83333333333333337, 6, 7, 1136, 8 },
+    { 0.071428571428571425, 0.5, 6, 7, 1144, 8 },
+    { 0.5, 0.071428571428571425, 7, 6, 1152, 8 },
+    { 0.9285714285714286, 0.5, 6, 7, 1160, 8 },
+    { 0.5, 0.9285714285714286, 7, 6, 1168, 8 },
+    { 0.0625, 0.5, 7, 8, 1176, 8 },
+    { 0.5, 0.0625, 8, 7, 1184, 8 },
+    { 0.9375, 0.5, 7, 8, 1192, 8 },
+    { 0.5, 0.9375, 8, 7, 1200, 8 },
+};
+
+static const coord_def los_ray_coords[LOS_NUM_RAY_COORDS] =
+{
+    {0,1},{0,2},{0,3},{0,4},{0,5},{0,6},{0,7},{0,8},{1,0},{2,0},
+    {3,0},{4,0},{5,0},{6,0},{7,0},{8,0},{1,1},{2,2},{3,3},{4,4},
+    {5,5},{6,6},{7,7},{8,8},{0,1},{1,2},{1,3},{2,4},{2,5},{3,6},
+    {3,7},{4,8},{1,0},{2,1},{3,1},{4,2},{5,2},{6,3},{7,3},{8,4},
+    {1,1},{1,2},{2,3},{2,4},{3,5},{3,6},{4,7},{4,8},{1,1},{2,1},
+    {3,2},{4,2},{5,3},{6,3},{7,4},{8,4},{0,1},{0,2},{1,3},{1,4},
+    {1,5},{2,6},{2,7},{2,8},{1,0},{2,0},{3,1},{4,1},{5,1},{6,2},
+    {7,2},{8,2},{0,1},{1,2},{1,3},{1,4},{2,5},{2,6},{2,7},{3,8},
+    {1,0},{2,1},{3,1},{4,1},{5,2},{6,2},{7,2},{8,3},{1,1},{1,2},
+    {1,3},{2,4},{2,5},{2,6},{3,7},{3,8},{1,1},{2,1},{3,1},{4,2},
+    {5,2},{6,2},{7,3},{8,3},{0,1},{0,2},{0,3},{1,4},{1,5},{1,6},
+    {1,7},{2,8},{1,0},{2,0},{3,0},{4,1},{5,1},{6,1},{7,1},{8,2},
+    {0,1},{0,2},{1,3},{1,4},{1,5},{1,6},{2,7},{2,8},{1,0},{2,0},
+    {3,1},{4,1},{5,1},{6,1},{7,2},{8,2},{0,1},{1,2},{1,3},{1,4},
+    {1,5},{2,6},{2,7},{2,8},{1,0},{2,1},{3,1},{4,1},{5,1},{6,2},
+    {7,2},{8,2},{1,1},{1,2},{1,3},{1,4},{2,5},{2,6},{2,7},{2,8},
+    {1,1},{2,1},{3,1},{4,1},{5,2},{6,2},{7,2},{8,2},{1,0},{2,0},
+    {3,1},{4,1},{5,1},{6,1},{7,1},{8,2},{0,1},{0,2},{1,3},{1,4},
+    {1,5},{1,6},{1,7},{2,8},{0,1},{0,2},{0,3},{0,4},{1,5},{1,6},
+    {1,7},{1,8},{1,0},{2,0},{3,0},{4,0},{5,1},{6,1},{7,1},{8,1},
+    {0,1},{0,2},{0,3},{1,4},{1,5},{1,6},{1,7},{1,8},{1,0},{2,0},
+    {3,0},{4,1},{5,1},{6,1},{7,1},{8,1},{0,1},{1,2},{1,3},{1,4},
+    {1,5},{1,6},{2,7},{2,8},{1,0},{2,1},{3,1},{4,1},{5,1},{6,1},
+    {7,2},{8,2},{1,1},{1,2},{1,3},{1,4},{1,5},{2,6},{2,7},{2,8},
+    {1,1},{2,1},{3,1},{4,1},{5,1},{6,2},{7,2},{8,2},{1,1},{2,1},
+    {3,2},{4,3},{5,3},{6,4},{7,5},{8,5},{1,1},{1,2},{2,3},{3,4},
+    {3,5},{4,6},{5,7},{5,8},{0,1},{0,2},{0,3},{0,4},{0,5},{1,6},
+    {1,7},{1,8},{1,0},{2,0},{3,0},{4,0},{5,0},{6,1},{7,1},{8,1},
+    {0,1},{0,2},{1,3},{1,4},{1,5},{1,6},{1,7},{1,8},{1,0},{2,0},
+    {3,1},{4,1},{5,1},{6,1},{7,1},{8,1},{0,1},{1,2},{1,3},{1,4},
+    {1,5},{1,6},{1,7},{2,8},{1,0},{2,1},{3,1},{4,1},{5,1},{6,1},
+    {7,1},{8,2},{1,1},{1,2},{1,3},{1,4},{1,5},{1,6},{2,7},{2,8},
+    {1,1},{2,1},{3,1},{4,1},{5,1},{6,1},{7,2},{8,2},{0,1},{1,2},
+    {2,3},{2,4},{3,5},{4,6},{4,7},{5,8},{1,0},{2,1},{3,2},{4,2},
+    {5,3},{6,4},{7,4},{8,5},{1,1},{2,2},{2,3},{3,4},{4,5},{4,6},
+    {5,7},{6,8},{1,1},{2,2},{3,2},{4,3},{5,4},{6,4},{7,5},{8,6},
+    {0,1},{0,2},{0,3},{0,4},{0,5},{0,6},{1,7},{1,8},{1,0},{2,0},
+    {3,0},{4,0},{5,0},{6,0},{7,1},{8,1},{0,1},{1,2},{1,3},{1,4},
+    {1,5},{1,6},{1,7},{1,8},{1,0},{2,1},{3,1},{4,1},{5,1},{6,1},
+    {7,1},{8,1},{1,1},{1,2},{1,3},{1,4},{1,5},{1,6},{1,7},{2,8},
+    {1,1},{2,1},{3,1},{4,1},{5,1},{6,1},{7,1},{8,2},{0,1},{0,2},
+    {0,3},{0,4},{0,5},{0,6},{0,7},{1,8},{1,0},{2,0},{3,0},{4,0},
+    {5,0},{6,0},{7,0},{8,1},{1,1},{1,2},{1,3},{1,4},{1,5},{1,6},
+    {1,7},{1,8},{1,1},{2,1},{3,1},{4,1},{5,1},{6,1},{7,1},{8,1},
+    {0,1},{0,2},{1,3},{1,4},{2,5},{2,6},{2,7},{3,8},{1,0},{2,0},
+    {3,1},{4,1},{5,2},{6,2},{7,2},{8,3},{0,1},{1,2},{1,3},{1,4},
+    {2,5},{2,6},{3,7},{3,8},{1,0},{2,1},{3,1},{4,1},{5,2},{6,2},
+    {7,3},{8,3},{0,1},{1,2},{1,3},{2,4},{2,5},{2,6},{3,7},{3,8},
+    {1,0},{2,1},{3,1},{4,2},{5,2},{6,2},{7,3},{8,3},{1,1},{1,2},
+    {1,3},{2,4},{2,5},{3,6},{3,7},{3,8},{1,1},{2,1},{3,1},{4,2},
+    {5,2},{6,3},{7,3},{8,3},{1,1},{1,2},{2,3},{2,4},{2,5},{3,6},
+    {3,7},{4,8},{1,1},{2,1},{3,2},{4,2},{5,2},{6,3},{7,3},{8,4},
+    {0,1},{1,2},{2,3},{3,4},{3,5},{4,6},{5,7},{6,8},{1,0},{2,1},
+    {3,2},{4,3},{5,3},{6,4},{7,5},{8,6},{1,1},{1,2},{2,3},{3,4},
+    {4,5},{4,6},{5,7},{6,8},{1,1},{2,1},{3,2},{4,3},{5,4},{6,4},
+    {7,5},{8,6},{1,1},{2,2},{2,3},{3,4},{4,5},{5,6},{5,7},{6,8},
+    {1,1},{2,2},{3,2},{4,3},{5,4},{6,5},{7,5},{8,6},{1,1},{2,2},
+    {3,3},{3,4},{4,5},{5,6},{6,7},{6,8},{1,1},{2,2},{3,3},{4,3},
+    {5,4},{6,5},{7,6},{8,6},{0,1},{0,2},{0,3},{1,4},{1,5},{1,6},
+    {2,7},{2,8},{1,0},{2,0},{3,0},{4,1},{5,1},{6,1},{7,2},{8,2},
+    {0,1},{1,2},{1,3},{1,4},{2,5},{2,6},{2,7},{2,8},{1,0},{2,1},
+    {3,1},{4,1},{5,2},{6,2},{7,2},{8,2},{1,1},{1,2},{1,3},{1,4},
+    {2,5},{2,6},{2,7},{3,8},{1,1},{2,1},{3,1},{4,1},{5,2},{6,2},
+    {7,2},{8,3},{1,1},{1,2},{1,3},{2,4},{2,5},{2,6},{2,7},{3,8},
+    {1,1},{2,1},{3,1},{4,2},{5,2},{6,2},{7,2},{8,3},{0,1},{1,2},
+    {1,3},{2,4},{3,5},{3,6},{4,7},{4,8},{1,0},{2,1},{3,1},{4,2},
+    {5,3},{6,3},{7,4},{8,4},{0,1},{1,2},{2,3},{2,4},{3,5},{3,6},
+    {4,7},{5,8},{1,0},{2,1},{3,2},{4,2},{5,3},{6,3},{7,4},{8,5},
+    {1,1},{1,2},{2,3},{2,4},{3,5},{4,6},{4,7},{5,8},{1,1},{2,1},
+    {3,2},{4,2},{5,3},{6,4},{7,4},{8,5},{1,1},{1,2},{2,3},{3,4},
+    {3,5},{4,6},{4,7},{5,8},{1,1},{2,1},{3,2},{4,3},{5,3},{6,4},
+    {7,4},{8,5},{1,1},{2,2},{2,3},{3,4},{3,5},{4,6},{5,7},{5,8},
+    {1,1},{2,2},{3,2},{4,3},{5,3},{6,4},{7,5},{8,5},{0,1},{1,2},
+    {2,3},{3,4},{4,5},{4,6},{5,7},{6,8},{1,0},{2,1},{3,2},{4,3},
+    {5,4},{6,4},{7,5},{8,6},{1,1},{1,2},{2,3},{3,4},{4,5},{5,6},
+    {5,7},{6,8},{1,1},{2,1},{3,2},{4,3},{5,4},{6,5},{7,5},{8,6},
+    {1,1},{2,2},{2,3},{3,4},{4,5},{5,6},{6,7},{6,8},{1,1},{2,2},
+    {3,2},{4,3},{5,4},{6,5},{7,6},{8,6},{1,1},{2,2},{3,3},{3,4},
+    {4,5},{5,6},{6,7},{7,8},{1,1},{2,2},{3,3},{4,3},{5,4},{6,5},
+    {7,6},{8,7},{1,1},{2,2},{3,3},{4,4},{4,5},{5,6},{6,7},{7,8},
+    {1,1},{2,2},{3,3},{4,4},{5,4},{6,5},{7,6},{8,7},{1,1},{2,1},
+    {3,1},{4,2},{5,2},{6,3},{7,3},{8,4},{1,1},{1,2},{1,3},{2,4},
+    {2,5},{3,6},{3,7},{4,8},{1,0},{2,1},{3,1},{4,2},{5,2},{6,3},
+    {7,3},{8,3},{0,1},{1,2},{1,3},{2,4},{2,5},{3,6},{3,7},{3,8},
+    {0,1},{0,2},{1,3},{1,4},{2,5},{2,6},{3,7},{3,8},{1,0},{2,0},
+    {3,1},{4,1},{5,2},{6,2},{7,3},{8,3},{1,1},{1,2},{2,3},{2,4},
+    {3,5},{3,6},{3,7},{4,8},{1,1},{2,1},{3,2},{4,2},{5,3},{6,3},
+    {7,3},{8,4},{0,1},{0,2},{1,3},{1,4},{1,5},{2,6},{2,7},{3,8},
+    {1,0},{2,0},{3,1},{4,1},{5,1},{6,2},{7,2},{8,3},{1,1},{1,2},
+    {2,3},{2,4},{2,5},{3,6},{3,7},{3,8},{1,1},{2,1},{3,2},{4,2},
+    {5,2},{6,3},{7,3},{8,3},{1,1},{2,1},{3,2},{4,2},{5,3},{6,3},
+    {7,4},{8,5},{1,1},{1,2},{2,3},{2,4},{3,5},{3,6},{4,7},{5,8},
+    {1,0},{2,1},{3,2},{4,2},{5,3},{6,3},{7,4},{8,4},{0,1},{1,2},
+    {2,3},{2,4},{3,5},{3,6},{4,7},{4,8},{0,1},{1,2},{1,3},{2,4},
+    {2,5},{3,6},{4,7},{4,8},{1,0},{2,1},{3,1},{4,2},{5,2},{6,3},
+    {7,4},{8,4},{1,1},{2,2},{2,3},{3,4},{3,5},{4,6},{4,7},{5,8},
+    {1,1},{2,2},{3,2},{4,3},{5,3},{6,4},{7,4},{8,5},{0,1},{1,2},
+    {2,3},{3,4},{4,5},{5,6},{5,7},{6,8},{1,0},{2,1},{3,2},{4,3},
+    {5,4},{6,5},{7,5},{8,6},{1,1},{1,2},{2,3},{3,4},{4,5},{5,6},
+    {6,7},{6,8},{1,1},{2,1},{3,2},{4,3},{5,4},{6,5},{7,6},{8,6},
+    {1,1},{2,2},{2,3},{3,4},{4,5},{5,6},{6,7},{7,8},{1,1},{2,2},
+    {3,2},{4,3},{5,4},{6,5},{7,6},{8,7},{1,1},{2,2},{3,3},{4,4},
+    {5,5},{5,6},{6,7},{7,8},{1,1},{2,2},{3,3},{4,4},{5,5},{6,5},
+    {7,6},{8,7},{1,1},{2,1},{3,2},{4,3},{5,3},{6,4},{7,5},{8,6},
+    {1,1},{1,2},{2,3},{3,4},{3,5},{4,6},{5,7},{6,8},{1,0},{2,1},
+    {3,2},{4,3},{5,3},{6,4},{7,5},{8,5},{0,1},{1,2},{2,3},{3,4},
+    {3,5},{4,6},{5,7},{5,8},{0,1},{1,2},{2,3},{2,4},{3,5},{4,6},
+    {5,7},{5,8},{1,0},{2,1},{3,2},{4,2},{5,3},{6,4},{7,5},{8,5},
+    {1,1},{2,2},{3,3},{3,4},{4,5},{5,6},{5,7},{6,8},{1,1},{2,2},
+    {3,3},{4,3},{5,4},{6,5},{7,5},{8,6},{0,1},{1,2},{1,3},{2,4},
+    {3,5},{3,6},{4,7},{5,8},{1,0},{2,1},{3,1},{4,2},{5,3},{6,3},
+    {7,4},{8,5},{1,1},{2,2},{2,3},{3,4},{4,5},{4,6},{5,7},{5,8},
+    {1,1},{2,2},{3,2},{4,3},{5,4},{6,4},{7,5},{8,5},{1,1},{2,1},
+    {3,2},{4,3},{5,4},{6,5},{7,6},{8,7},{1,1},{1,2},{2,3},{3,4},
+    {4,5},{5,6},{6,7},{7,8},{0,1},{1,2},{2,3},{3,4},{4,5},{5,6},
+    {6,7},{6,8},{1,0},{2,1},{3,2},{4,3},{5,4},{6,5},{7,6},{8,6},
+    {1,1},{2,2},{3,3},{4,4},{5,5},{6,6},{6,7},{7,8},{1,1},{2,2},
+    {3,3},{4,4},{5,5},{6,6},{7,6},{8,7},{0,1},{1,2},{2,3},{3,4},
+    {4,5},{5,6},{6,7},{7,8},{1,0},{2,1},{3,2},{4,3},{5,4},{6,5},
+    {7,6},{8,7},{1,1},{2,2},{3,3},{4,4},{5,5},{6,6},{7,7},{7,8},
+    {1,1},{2,2},{3,3},{4,4},{5,5},{6,6},{7,7},{8,7},
+};
+
+static const coord_def los_cellray_ends[LOS_NUM_CELLRAYS] =
+{
+    {1,0},{2,0},{3,0},{4,0},{5,0},{6,0},{7,0},{8,0},{0,1},{1,1},
+    {2,1},{2,1},{3,1},{3,1},{3,1},{4,1},{4,1},{4,1},{4,1},{5,1},
+    {5,1},{5,1},{5,1},{5,1},{6,1},{6,1},{6,1},{6,1},{6,1},{6,1},
+    {7,1},{7,1},{7,1},{7,1},{7,1},{7,1},{7,1},{8,1},{8,1},{8,1},
+    {8,1},{8,1},{8,1},{8,1},{8,1},{0,2},{1,2},{1,2},{2,2},{3,2},
+    {3,2},{3,2},{4,2},{4,2},{4,2},{4,2},{5,2},{5,2},{5,2},{5,2},
+    {5,2},{5,2},{6,2},{6,2},{6,2},{6,2},{6,2},{6,2},{6,2},{6,2},
+    {7,2},{7,2},{7,2},{7,2},{7,2},{7,2},{7,2},{7,2},{7,2},{7,2},
+    {7,2},{8,2},{8,2},{8,2},{8,2},{8,2},{8,2},{8,2},{8,2},{8,2},
+    {8,2},{8,2},{8,2},{8,2},{0,3},{1,3},{1,3},{1,3},{2,3},{2,3},
+    {2,3},{3,3},{4,3},{4,3},{4,3},{4,3},{5,3},{5,3},{5,3},{5,3},
+    {5,3},{5,3},{6,3},{6,3},{6,3},{6,3},{6,3},{6,3},{7,3},{7,3},
+    {7,3},{7,3},{7,3},{7,3},{7,3},{7,3},{8,3},{8,3},{8,3},{8,3},
+    {8,3},{8,3},{8,3},{8,3},{8,3},{8,3},{8,3},{8,3},{0,4},{1,4},
+    {1,4},{1,4},{1,4},{2,4},{2,4},{2,4},{2,4},{3,4},{3,4},{3,4},
+    {3,4},{4,4},{5,4},{5,4},{5,4},{5,4},{5,4},{6,4},{6,4},{6,4},
+    {6,4},{6,4},{6,4},{6,4},{6,4},{7,4},{7,4},{7,4},{7,4},{7,4},
+    {7,4},{7,4},{7,4},{8,4},{8,4},{8,4},{8,4},{8,4},{8,4},{8,4},
+    {8,4},{0,5},{1,5},{1,5},{1,5},{1,5},{1,5},{2,5},{2,5},{2,5},
+    {2,5},{2,5},{2,5},{3,5},{3,5},{3,5},{3,5},{3,5},{3,5},{4,5},
+    {4,5},{4,5},{4,5},{4,5},{5,5},{6,5},{6,5},{6,5},{6,5},{6,5},
+    {6,5},{7,5},{7,5},{7,5},{7,5},{7,5},{7,5},{7,5},{7,5},{7,5},
+    {7,5},{7,5},{8,5},{8,5},{8,5},{8,5},{8,5},{8,5},{8,5},{8,5},
+    {8,5},{8,5},{8,5},{8,5},{0,6},{1,6},{1,6},{1,6},{1,6},{1,6},
+    {1,6},{2,6},{2,6},{2,6},{2,6},{2,6},{2,6},{2,6},{2,6},{3,6},
+    {3,6},{3,6},{3,6},{3,6},{3,6},{4,6},{4,6},{4,6},{4,6},{4,6},
+    {4,6},{4,6},{4,6},{5,6},{5,6},{5,6},{5,6},{5,6},{5,6},{6,6},
+    {7,6},{7,6},{7,6},{7,6},{7,6},{7,6},{7,6},{8,6},{8,6},{8,6},
+    {8,6},{8,6},{8,6},{8,6},{8,6},{8,6},{8,6},{8,6},{8,6},{8,6},
+    {0,7},{1,7},{1,7},{1,7},{1,7},{1,7},{1,7},{1,7},{2,7},{2,7},
+    {2,7},{2,7},{2,7},{2,7},{2,7},{2,7},{2,7},{2,7},{2,7},{3,7},
+    {3,7},{3,7},{3,7},{3,7},{3,7},{3,7},{3,7},{4,7},{4,7},{4,7},
+    {4,7},{4,7},{4,7},{4,7},{4,7},{5,7},{5,7},{5,7},{5,7},{5,7},
+    {5,7},{5,7},{5,7},{5,7},{5,7},{5,7},{6,7},{6,7},{6,7},{6,7},
+    {6,7},{6,7},{6,7},{7,7},{8,7},{8,7},{8,7},{8,7},{8,7},{8,7},
+    {8,7},{8,7},{0,8},{1,8},{1,8},{1,8},{1,8},{1,8},{1,8},{1,8},
+    {1,8},{2,8},{2,8},{2,8},{2,8},{2,8},{2,8},{2,8},{2,8},{2,8},
+    {2,8},{2,8},{2,8},{2,8},{3,8},{3,8},{3,8},{3,8},{3,8},{3,8},
+    {3,8},{3,8},{3,8},{3,8},{3,8},{3,8},{4,8},{4,8},{4,8},{4,8},
+    {4,8},{4,8},{4,8},{4,8},{5,8},{5,8},{5,8},{5,8},{5,8},{5,8},
+    {5,8},{5,8},{5,8},{5,8},{5,8},{5,8},{6,8},{6,8},{6,8},{6,8},
+    {6,8},{6,8},{6,8},{6,8},{6,8},{6,8},{6,8},{6,8},{6,8},{7,8},
+    {7,8},{7,8},{7,8},{7,8},{7,8},{7,8},{7,8},{8,8},
+};
+
+static const los_table_cellray los_min_cellrays[LOS_NUM_CELLRAYS] =
+{
+    {1,0},{1,1},{1,2},{1,3},{1,4},{1,5},{1,6},{1,7},
+    {0,0},{2,0},{6,1},{4,1},{4,2},{12,2},{8,2},{8,3},
+    {10,3},{20,3},{14,3},{8,4},{14,4},{18,4},{30,4},{24,4},
+    {14,5},{16,5},{24,5},{28,5},{40,5},{34,5},{14,6},{21,6},
+    {24,6},{34,6},{38,6},{50,6},{46,6},{24,7},{26,7},{34,7},
+    {36,7},{46,7},{48,7},{54,7},{52,7},{0,1},{5,1},{3,1},
+    {2,1},{6,2},{44,2},{42,2},{6,3},{4,3},{12,3},{42,3},
+    {4,4},{12,4},{64,4},{10,4},{56,4},{20,4},{12,5},{8,5},
+    {10,5},{56,5},{60,5},{20,5},{18,5},{30,5},{8,6},{10,6},
+    {56,6},{20,6},{80,6},{16,6},{18,6},{74,6},{30,6},{28,6},
+    {40,6},{8,7},{20,7},{14,7},{16,7},{18,7},{74,7},{76,7},
+    {30,7},{21,7},{28,7},{40,7},{38,7},{50,7},{0,2},{3,2},
+    {11,2},{7,2},{5,2},{43,2},{41,2},{2,2},{31,3},{44,3},
+    {72,3},{66,3},{6,4},{31,4},{90,4},{42,4},{82,4},{66,4},
+    {6,5},{4,5},{62,5},{64,5},{82,5},{84,5},{4,6},{12,6},
+    {62,6},{64,6},{108,6},{58,6},{60,6},{106,6},{12,7},{62,7},
+    {112,7},{10,7},{56,7},{58,7},{60,7},{103,7},{106,7},{110,7},
+    {78,7},{80,7},{0,3},{7,3},{9,3},{19,3},{13,3},{5,3},
+    {3,3},{11,3},{41,3},{32,3},{43,3},{71,3},{65,3},{2,3},
+    {44,4},{68,4},{72,4},{100,4},{92,4},{31,5},{44,5},{86,5},
+    {90,5},{42,5},{68,5},{66,5},{92,5},{6,6},{86,6},{88,6},
+    {120,6},{42,6},{82,6},{84,6},{118,6},{6,7},{4,7},{64,7},
+    {101,7},{108,7},{82,7},{115,7},{118,7},{0,4},{7,4},{13,4},
+    {17,4},{29,4},{23,4},{3,4},{11,4},{63,4},{9,4},{55,4},
+    {19,4},{5,4},{32,4},{89,4},{41,4},{81,4},{65,4},{43,4},
+    {67,4},{71,4},{99,4},{91,4},{2,4},{70,5},{72,5},{94,5},
+    {100,5},{128,5},{122,5},{31,6},{44,6},{90,6},{68,6},{70,6},
+    {136,6},{66,6},{134,6},{94,6},{92,6},{122,6},{31,7},{86,7},
+    {88,7},{90,7},{113,7},{120,7},{140,7},{42,7},{84,7},{138,7},
+    {131,7},{134,7},{0,5},{13,5},{15,5},{23,5},{27,5},{39,5},
+    {33,5},{11,5},{7,5},{9,5},{55,5},{59,5},{19,5},{17,5},
+    {29,5},{5,5},{3,5},{61,5},{63,5},{81,5},{83,5},{32,5},
+    {43,5},{85,5},{89,5},{41,5},{67,5},{65,5},{91,5},{69,5},
+    {71,5},{93,5},{99,5},{127,5},{121,5},{2,5},{72,6},{96,6},
+    {100,6},{124,6},{128,6},{146,6},{144,6},{44,7},{68,7},{70,7},
+    {72,7},{129,7},{136,7},{66,7},{94,7},{96,7},{92,7},{124,7},
+    {122,7},{144,7},{0,6},{13,6},{22,6},{23,6},{33,6},{37,6},
+    {49,6},{45,6},{7,6},{9,6},{55,6},{19,6},{79,6},{15,6},
+    {17,6},{73,6},{29,6},{27,6},{39,6},{3,6},{11,6},{61,6},
+    {63,6},{107,6},{57,6},{59,6},{105,6},{5,6},{85,6},{87,6},
+    {119,6},{41,6},{81,6},{83,6},{117,6},{32,6},{43,6},{89,6},
+    {67,6},{69,6},{135,6},{65,6},{133,6},{93,6},{91,6},{121,6},
+    {71,6},{95,6},{99,6},{123,6},{127,6},{145,6},{143,6},{2,6},
+    {98,7},{100,7},{126,7},{128,7},{141,7},{146,7},{150,7},{148,7},
+    {0,7},{23,7},{25,7},{33,7},{35,7},{45,7},{47,7},{53,7},
+    {51,7},{7,7},{19,7},{13,7},{15,7},{17,7},{73,7},{75,7},
+    {29,7},{22,7},{27,7},{39,7},{37,7},{49,7},{11,7},{61,7},
+    {111,7},{9,7},{55,7},{57,7},{59,7},{104,7},{105,7},{109,7},
+    {77,7},{79,7},{5,7},{3,7},{63,7},{102,7},{107,7},{81,7},
+    {116,7},{117,7},{32,7},{85,7},{87,7},{89,7},{114,7},{119,7},
+    {139,7},{41,7},{83,7},{137,7},{132,7},{133,7},{43,7},{67,7},
+    {69,7},{71,7},{130,7},{135,7},{65,7},{93,7},{95,7},{91,7},
+    {123,7},{121,7},{143,7},{97,7},{99,7},{125,7},{127,7},{142,7},
+    {145,7},{149,7},{147,7},{2,7},
+};
+
+static const unsigned short los_min_cellrays_first[(LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1) + 1] =
+{
+    0, 0, 1, 2, 3, 4, 5, 6, 7, 8,
+    9, 10, 12, 15, 19, 24, 30, 37, 45, 46,
+    48, 49, 52, 56, 62, 70, 81, 94, 95, 98,
+    101, 102, 106, 112, 118, 126, 138, 139, 143, 147,
+    151, 152, 157, 165, 173, 181, 182, 187, 193, 199,
+    204, 205, 211, 222, 234, 235, 241, 249, 255, 263,
+    269, 270, 277, 290, 291, 298, 309, 317, 325, 336,
+    343, 344, 352, 353, 361, 374, 386, 394, 406, 419,
+    427, 428,
+};
+
+alignas(LOS_MASK_ALIGN) static const los_mask_word
+los_blockray_masks[(LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1)][LOS_MASK_WORDS] =
+{
+    { // (0,0)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,0)
+        0xd3940fefdf7bb4feULL, 0x5371710032decbf2ULL, 0x001929d1480001c7ULL, 0x000001c19a220000ULL,
+        0x0000000224480000ULL, 0x0000000040000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (2,0)
+        0x50000bebd75aa0fcULL, 0x10000000104ec150ULL, 0x0000000000000181ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (3,0)
+        0x00000aeb555200f8ULL, 0x0000000010048000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (4,0)
+        0x00000aab144000f0ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,0)
+        0x00000a8a100000e0ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,0)
+        0x00000a08000000c0ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,0)
+        0x0000080000000080ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,0)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,1)
+        0x0000600000000000ULL, 0x00000009c0000000ULL, 0x9be000000024bc00ULL, 0x6396fc0000000438ULL,
+        0xc9acbdfc00000845ULL, 0xc772deff00206889ULL, 0x00000204489c1b25ULL, 0x0000000000000000ULL,
+    },
+    { // (1,1)
+        0x2c6b901020844800ULL, 0xac8e8ef60d21340dULL, 0x6406d62eb7db4238ULL, 0x9c69023e65ddfbc7ULL,
+        0x36534201dbb7f7baULL, 0x388d2100bfdf9776ULL, 0x00000dfbb763e4daULL, 0x0000000000000000ULL,
+    },
+    { // (2,1)
+        0xaff6141428a55000ULL, 0xefff7d402fb13eafULL, 0x001feff76a00027eULL, 0x000001d7de6a8000ULL,
+        0x00000002ecca0000ULL, 0x0000000050000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (3,1)
+        0xdf501514aaad8000ULL, 0xd7d540002ffb7fffULL, 0x00132880000001ffULL, 0x0000010000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (4,1)
+        0xda001554ebb80000ULL, 0x510000003ffeffdeULL, 0x0000000000000193ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,1)
+        0x40001575ef000000ULL, 0x000000001fdebb4aULL, 0x0000000000000100ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,1)
+        0x000015f7c0000000ULL, 0x000000001ecca900ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,1)
+        0x000017e000000000ULL, 0x000000000a440000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,1)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,2)
+        0x0000000000000000ULL, 0x0000000140000000ULL, 0x82e0000000002c00ULL, 0x0082bc0000000000ULL,
+        0x080c157c00000000ULL, 0x81104ebf00000000ULL, 0x0000000000000001ULL, 0x0000000000000000ULL,
+    },
+    { // (1,2)
+        0x0000000000000000ULL, 0x0000000e80000000ULL, 0x7d000000002fd000ULL, 0xff7d40000000053fULL,
+        0xf7f3ea8000000a5dULL, 0x7eefb140002879afULL, 0x00000285d99d7ffeULL, 0x0000000000000000ULL,
+    },
+    { // (2,2)
+        0x0008000000000000ULL, 0x000082b000000000ULL, 0x0000100895d00000ULL, 0x0000022821957ac0ULL,
+        0x000000011335f5a2ULL, 0x00000000afd78650ULL, 0x00000d7a26628000ULL, 0x0000000000000000ULL,
+    },
+    { // (3,2)
+        0x20a0000000000000ULL, 0x282abdc000000000ULL, 0x000cd77feb000200ULL, 0x000002ffdffaa000ULL,
+        0x00000002fdea8000ULL, 0x0000000054000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (4,2)
+        0x2500000000000000ULL, 0xaeff540000010021ULL, 0x001febe44000026cULL, 0x0000019390000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,2)
+        0x8000000000000000ULL, 0xdfcd0000202144b5ULL, 0x0012a800000002ffULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,2)
+        0x0000000000000000ULL, 0xd3800000213356c0ULL, 0x00000000000001b7ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,2)
+        0x0000000000000000ULL, 0x4000000035ba0000ULL, 0x0000000000000131ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,2)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,3)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x02a0000000002400ULL, 0x0000ac0000000000ULL,
+        0x0008016c00000000ULL, 0x001004af00000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,3)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0xfd4000000002d800ULL, 0x2bff500000000020ULL,
+        0x8bf7fe9000000000ULL, 0xffeffb5000000008ULL, 0x0000000000100265ULL, 0x0000000000000000ULL,
+    },
+    { // (2,3)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x00000000003d0000ULL, 0xd4000000000005dfULL,
+        0x7400000000000affULL, 0x00000000002a7ff7ULL, 0x000002a5fbeffd9aULL, 0x0000000000000000ULL,
+    },
+    { // (3,3)
+        0x0000000000000000ULL, 0x0000020000000000ULL, 0x0000000014c00000ULL, 0x0000000020055a00ULL,
+        0x0000000102157500ULL, 0x00000000abd58000ULL, 0x00000d5a04000000ULL, 0x0000000000000000ULL,
+    },
+    { // (4,3)
+        0x0000000000000000ULL, 0x0000a80000000000ULL, 0x0000141baf000000ULL, 0x0000026c6ffae000ULL,
+        0x00000003ffeac000ULL, 0x0000000055000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,3)
+        0x0000000000000000ULL, 0x2032000000000000ULL, 0x000d57ed60000000ULL, 0x000001ffd1280000ULL,
+        0x0000000080400000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,3)
+        0x0000000000000000ULL, 0x2c40000000000000ULL, 0x001fe9a000000248ULL, 0x0000011100000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,3)
+        0x0000000000000000ULL, 0x8000000000000000ULL, 0x0006a000000002ceULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,3)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0220000000000000ULL, 0x0000a40000000000ULL,
+        0x0000016400000000ULL, 0x000000ab00000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0xd5c0000000000000ULL, 0x00f7580000000000ULL,
+        0x088ffe9800000000ULL, 0x937fff5400000000ULL, 0x0000000000000001ULL, 0x0000000000000000ULL,
+    },
+    { // (2,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x2800000000000000ULL, 0x7f0800000000002bULL,
+        0xf770000000000011ULL, 0x6c8000000000400bULL, 0x0000000000193bfeULL, 0x0000000000000000ULL,
+    },
+    { // (3,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x80000000000007d4ULL,
+        0x0000000000000beeULL, 0x00000000002bbff4ULL, 0x000002afffe6c400ULL, 0x0000000000000000ULL,
+    },
+    { // (4,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000010000000ULL, 0x0000000000051800ULL,
+        0x0000000000153400ULL, 0x00000000aad40000ULL, 0x00000d5000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000001280000000ULL, 0x000002002ed3e000ULL,
+        0x000000037fabc000ULL, 0x0000000057000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000164000000000ULL, 0x000002eed3780000ULL,
+        0x0000000084e00000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0019400000000000ULL, 0x0000013780000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,4)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000840000000000ULL,
+        0x0000014400000000ULL, 0x000000a900000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0053780000000000ULL,
+        0x000bb6b800000000ULL, 0x001fdf5600000000ULL, 0x0000000000000001ULL, 0x0000000000000000ULL,
+    },
+    { // (2,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x1bac000000000000ULL,
+        0x0ff4480000000000ULL, 0xffe0200000000008ULL, 0x0000000000000256ULL, 0x0000000000000000ULL,
+    },
+    { // (3,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xe400000000000000ULL,
+        0xf000000000000035ULL, 0x00000000000044b7ULL, 0x00000001009ffda8ULL, 0x0000000000000000ULL,
+    },
+    { // (4,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000fcaULL, 0x00000000002fbb40ULL, 0x000002beff600000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000040000ULL,
+        0x0000000000143000ULL, 0x00000000a8d00000ULL, 0x00000d4000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x000000002c800000ULL,
+        0x000000037b0fc000ULL, 0x000000005f000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x000002c840000000ULL,
+        0x00000001ade00000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,5)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000010400000000ULL, 0x000000a100000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x000a92f800000000ULL, 0x001ecd5e00000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (2,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x09d56c0000000000ULL, 0xb7e1320000000000ULL, 0x0000000000000001ULL, 0x0000000000000000ULL,
+    },
+    { // (3,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0xb620000000000000ULL, 0x4800000000000009ULL, 0x00000000001113feULL, 0x0000000000000000ULL,
+    },
+    { // (4,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x4000000000000000ULL, 0x0000000000004df6ULL, 0x0000000109eeec00ULL, 0x0000000000000000ULL,
+    },
+    { // (5,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x00000000003fb200ULL, 0x000002fef6000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000100000ULL, 0x00000000a0c00000ULL, 0x00000d0000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000252000000ULL, 0x000000007f000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,6)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000008100000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x000a457e00000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (2,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x3175ba0000000000ULL, 0x0000000000000001ULL, 0x0000000000000000ULL,
+    },
+    { // (3,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0xce80000000000000ULL, 0x00000000000000d6ULL, 0x0000000000000000ULL,
+    },
+    { // (4,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000137b28ULL, 0x0000000000000000ULL,
+    },
+    { // (5,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x000000035bec8400ULL, 0x0000000000000000ULL,
+    },
+    { // (6,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x000003fca4000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000080000000ULL, 0x00000c0000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,7)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (0,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (1,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (2,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (3,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (4,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (5,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (6,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (7,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+    { // (8,8)
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+        0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    },
+};
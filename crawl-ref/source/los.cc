@@ -30,10 +30,11 @@
  *
  * == Overview ==
  *
- * At first use, the LOS code makes some precomputations,
+ * At build time, util/gen-los-tables.cc makes some precomputations,
  * filling a list of all relevant rays in one quadrant,
  * and filling data structures that allow calculating LOS
- * in a quadrant without checking each ray.
+ * in a quadrant without checking each ray. These end up
+ * in los-tables.h as static data.
  *
  * The code provides functions for filling LOS information
  * around a given center efficiently, and for querying rays
@@ -46,50 +47,55 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define LOS_MASK_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define LOS_MASK_SSE2
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+# include <intrin.h>
+#endif
 
 #include "areas.h"
 #include "coord.h"
 #include "coordit.h"
 #include "env.h"
+#include "los-tables.h"
 #include "losglobal.h"
 #include "mon-act.h"
 #include "mpr.h"
-
-// These determine what rays are cast in the precomputation,
-// and affect start-up time significantly.
-// XXX: Argue that these values are sufficient.
-#define LOS_MAX_ANGLE (2*LOS_MAX_RANGE-2)
-#define LOS_INTERCEPT_MULT (2)
-
-// These store all unique (in terms of footprint) full rays.
-// The footprint of ray=fullray[i] consists of ray.length cells,
-// stored in ray_coords[ray.start..ray.length-1].
-// These are filled during precomputation (_register_ray).
-// XXX: fullrays is not needed anymore after precomputation.
-struct los_ray;
-static vector<los_ray> fullrays;
-static vector<coord_def> ray_coords;
-
-// These store all unique minimal cellrays. For each i,
-// cellray i ends in cellray_ends[i] and passes through
-// those cells p that have blockrays(p)[i] set. In other
-// words, blockrays(p)[i] is set iff an opaque cell p blocks
-// the cellray with index i.
-static vector<coord_def> cellray_ends;
-typedef FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
-static blockrays_t blockrays;
-
-// We also store the minimal cellrays by target position
-// for efficient retrieval by find_ray.
-// XXX: Consider condensing this representation.
-struct cellray;
-static FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> min_cellrays;
-
-// Temporary arrays used in losight() to track which rays
-// are blocked or have seen a smoke cloud.
-// Allocated when doing the precomputations.
-static bit_vector *dead_rays     = nullptr;
-static bit_vector *smoke_rays    = nullptr;
+#include "threads.h"
+
+// The rays are precomputed at build time by util/gen-los-tables.cc,
+// which casts a large bundle of rays through the first quadrant and
+// keeps those that are unique in terms of footprint (the fullrays).
+//
+// The blockray masks are what losight() spends its time on, so they
+// are stored as fixed-width masks, one per quadrant cell. The mask
+// width is enough 64-bit words for all minimal cellrays, rounded up
+// to a whole cache line, so that masks can be combined a vector
+// register at a time without any tail handling.
+//
+// The tables themselves are static read-only data:
+// * los_fullrays and los_ray_coords hold the fullrays. The
+//   footprint of fullray i consists of los_fullrays[i].length
+//   cells, stored in los_ray_coords[start..start+length-1].
+// * los_cellray_ends: all unique minimal cellrays. For each i,
+//   cellray i ends in los_cellray_ends[i] and passes through
+//   those cells p that have bit i of _blockray_mask(p) set. In
+//   other words, that bit is set iff an opaque cell p blocks
+//   the cellray with index i.
+// * los_min_cellrays: the minimal cellrays again, grouped by target
+//   position and sorted best first, for efficient retrieval by
+//   find_ray. Those ending at p are the los_min_cellrays from
+//   los_min_cellrays_first[_quadrant_index(p)] up to the next entry.
+
+COMPILE_CHECK(LOS_MASK_WORDS * sizeof(los_mask_word) % LOS_MASK_ALIGN == 0);
 
 class quadrant_iterator : public rectangle_iterator
 {
@@ -101,12 +107,14 @@ public:
     }
 };
 
-void clear_rays_on_exit()
+static inline int _quadrant_index(const coord_def& p)
 {
-    delete dead_rays;
-    delete smoke_rays;
-    for (quadrant_iterator qi; qi; ++qi)
-        delete blockrays(*qi);
+    return p.y * (LOS_MAX_RANGE+1) + p.x;
+}
+
+static inline const los_mask_word *_blockray_mask(const coord_def& p)
+{
+    return los_blockray_masks[_quadrant_index(p)];
 }
 
 // LOS radius.
@@ -127,421 +135,6 @@ int get_los_radius()
     return los_radius;
 }
 
-bool double_is_zero(const double x)
-{
-    return x > -EPSILON_VALUE && x < EPSILON_VALUE;
-}
-
-struct los_ray : public ray_def
-{
-    // The footprint of this ray is stored in
-    // ray_coords[start..start+length-1].
-    unsigned int start;
-    unsigned int length;
-
-    los_ray(geom::ray _r)
-        : ray_def(_r), start(0), length(0)
-    {
-    }
-
-    // Shoot a ray from the given start point (accx, accy) with the given
-    // slope, bounded by the pre-calc bounds shape.
-    // Returns the cells it travels through, excluding the origin.
-    // Returns an empty vector if this was a bad ray.
-    vector<coord_def> footprint()
-    {
-        vector<coord_def> cs;
-        los_ray copy = *this;
-        coord_def c;
-        coord_def old;
-        int cellnum;
-        for (cellnum = 0; true; ++cellnum)
-        {
-            old = c;
-            if (!copy.advance())
-            {
-//                dprf("discarding corner ray (%f,%f) + t*(%f,%f)",
-//                     r.start.x, r.start.y, r.dir.x, r.dir.y);
-                cs.clear();
-                break;
-            }
-            c = copy.pos();
-            if (c.rdist() > LOS_RADIUS)
-                break;
-            cs.push_back(c);
-            ASSERT((c - old).rdist() == 1);
-        }
-        return cs;
-    }
-
-    coord_def operator[](unsigned int i)
-    {
-        ASSERT(i < length);
-        return ray_coords[start+i];
-    }
-};
-
-// Check if the passed rays have identical footprint.
-static bool _is_same_ray(los_ray ray, vector<coord_def> newray)
-{
-    if (ray.length != newray.size())
-        return false;
-    for (unsigned int i = 0; i < ray.length; i++)
-        if (ray[i] != newray[i])
-            return false;
-    return true;
-}
-
-// Check if the passed ray has already been created.
-static bool _is_duplicate_ray(vector<coord_def> newray)
-{
-    for (los_ray lray : fullrays)
-        if (_is_same_ray(lray, newray))
-            return true;
-    return false;
-}
-
-// A cellray given by fullray and index of end-point.
-struct cellray
-{
-    // A cellray passes through cells ray_coords[ray.start..ray.start+end].
-    los_ray ray;
-    unsigned int end; // Relative index (inside ray) of end cell.
-
-    cellray(const los_ray& r, unsigned int e)
-        : ray(r), end(e), imbalance(-1), first_diag(false)
-    {
-    }
-
-    // The end-point's index inside ray_coord.
-    int index() const { return ray.start + end; }
-
-    // The end-point.
-    coord_def target() const { return ray_coords[index()]; }
-
-    // XXX: Currently ray/cellray[0] is the first point outside the origin.
-    coord_def operator[](unsigned int i)
-    {
-        ASSERT(i <= end);
-        return ray_coords[ray.start+i];
-    }
-
-    // Parameters used in find_ray. These need to be calculated
-    // only for the minimal cellrays.
-    int imbalance;
-    bool first_diag;
-
-    void calc_params();
-};
-
-// Compare two cellrays to the same target.
-// This determines which ray is considered better by find_ray,
-// used with list::sort.
-// Returns true if a is strictly better than b, false else.
-static bool _is_better(const cellray& a, const cellray& b)
-{
-    // Only compare cellrays with equal target.
-    ASSERT(a.target() == b.target());
-    // calc_params() has been called.
-    ASSERT(a.imbalance >= 0);
-    ASSERT(b.imbalance >= 0);
-    if (a.imbalance < b.imbalance)
-        return true;
-    else if (a.imbalance > b.imbalance)
-        return false;
-    else
-        return a.first_diag && !b.first_diag;
-}
-
-enum class compare_type
-{
-    neither,
-    subray,
-    superray,
-};
-
-// Check whether one of the passed cellrays is a subray of the
-// other in terms of footprint.
-static compare_type _compare_cellrays(const cellray& a, const cellray& b)
-{
-    if (a.target() != b.target())
-        return compare_type::neither;
-
-    int cura = a.ray.start;
-    int curb = b.ray.start;
-    int enda = cura + a.end;
-    int endb = curb + b.end;
-    bool maybe_sub = true;
-    bool maybe_super = true;
-
-    while (cura < enda && curb < endb && (maybe_sub || maybe_super))
-    {
-        coord_def pa = ray_coords[cura];
-        coord_def pb = ray_coords[curb];
-        if (pa.x > pb.x || pa.y > pb.y)
-        {
-            maybe_super = false;
-            curb++;
-        }
-        if (pa.x < pb.x || pa.y < pb.y)
-        {
-            maybe_sub = false;
-            cura++;
-        }
-        if (pa == pb)
-        {
-            cura++;
-            curb++;
-        }
-    }
-    maybe_sub = maybe_sub && cura == enda;
-    maybe_super = maybe_super && curb == endb;
-
-    if (maybe_sub)
-        return compare_type::subray;    // includes equality
-    else if (maybe_super)
-        return compare_type::superray;
-    else
-        return compare_type::neither;
-}
-
-// Determine all minimal cellrays.
-// They're stored globally by target in min_cellrays,
-// and returned as a list of indices into ray_coords.
-static vector<int> _find_minimal_cellrays()
-{
-    FixedArray<list<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> minima;
-    list<cellray>::iterator min_it;
-
-    for (los_ray ray : fullrays)
-    {
-        for (unsigned int i = 0; i < ray.length; ++i)
-        {
-            // Is the cellray ray[0..i] duplicated so far?
-            bool dup = false;
-            cellray c(ray, i);
-            list<cellray>& min = minima(c.target());
-
-            bool erased = false;
-            for (min_it = min.begin();
-                 min_it != min.end() && !dup;)
-            {
-                switch (_compare_cellrays(*min_it, c))
-                {
-                case compare_type::subray:
-                    dup = true;
-                    break;
-                case compare_type::superray:
-                    min_it = min.erase(min_it);
-                    erased = true;
-                    // clear this should be added, but might have
-                    // to erase more
-                    break;
-                case compare_type::neither:
-                default:
-                    break;
-                }
-                if (!erased)
-                    ++min_it;
-                else
-                    erased = false;
-            }
-            if (!dup)
-                min.push_back(c);
-        }
-    }
-
-    vector<int> result;
-    for (quadrant_iterator qi; qi; ++qi)
-    {
-        list<cellray>& min = minima(*qi);
-        for (min_it = min.begin(); min_it != min.end(); ++min_it)
-        {
-            // Calculate imbalance and slope difference for sorting.
-            min_it->calc_params();
-            result.push_back(min_it->index());
-        }
-        min.sort(_is_better);
-        min_cellrays(*qi) = vector<cellray>(min.begin(), min.end());
-    }
-    return result;
-}
-
-// Create and register the ray defined by the arguments.
-static void _register_ray(geom::ray r)
-{
-    los_ray ray = los_ray(r);
-    vector<coord_def> coords = ray.footprint();
-
-    if (coords.empty() || _is_duplicate_ray(coords))
-        return;
-
-    ray.start = ray_coords.size();
-    ray.length = coords.size();
-    for (coord_def c : coords)
-        ray_coords.push_back(c);
-    fullrays.push_back(ray);
-}
-
-static void _create_blockrays()
-{
-    // First, we calculate blocking information for all cell rays.
-    // Cellrays are numbered according to the index of their end
-    // cell in ray_coords.
-    const int n_cellrays = ray_coords.size();
-    blockrays_t all_blockrays;
-    for (quadrant_iterator qi; qi; ++qi)
-        all_blockrays(*qi) = new bit_vector(n_cellrays);
-
-    for (los_ray ray : fullrays)
-    {
-        for (unsigned int i = 0; i < ray.length; ++i)
-        {
-            // Every cell is contained in (thus blocks)
-            // all following cellrays.
-            for (unsigned int j = i + 1; j < ray.length; ++j)
-                all_blockrays(ray[i])->set(ray.start + j);
-        }
-    }
-
-    // We've built the basic blockray array; now compress it, keeping
-    // only the nonduplicated cellrays.
-
-    // Determine minimal cellrays and store their indices in ray_coords.
-    vector<int> min_indices = _find_minimal_cellrays();
-    const int n_min_rays    = min_indices.size();
-    cellray_ends.resize(n_min_rays);
-    for (int i = 0; i < n_min_rays; ++i)
-        cellray_ends[i] = ray_coords[min_indices[i]];
-
-    // Compress blockrays accordingly.
-    for (quadrant_iterator qi; qi; ++qi)
-    {
-        blockrays(*qi) = new bit_vector(n_min_rays);
-        for (int i = 0; i < n_min_rays; ++i)
-        {
-            blockrays(*qi)->set(i, all_blockrays(*qi)
-                                   ->get(min_indices[i]));
-        }
-    }
-
-    // We can throw away all_blockrays now.
-    for (quadrant_iterator qi; qi; ++qi)
-        delete all_blockrays(*qi);
-
-    dead_rays  = new bit_vector(n_min_rays);
-    smoke_rays = new bit_vector(n_min_rays);
-
-    dprf("Cellrays: %d Fullrays: %u Minimal cellrays: %u",
-          n_cellrays, (unsigned int)fullrays.size(), n_min_rays);
-}
-
-static int _gcd(int x, int y)
-{
-    int tmp;
-    while (y != 0)
-    {
-        x %= y;
-        tmp = x;
-        x = y;
-        y = tmp;
-    }
-    return x;
-}
-
-static bool _complexity_lt(const pair<int,int>& lhs, const pair<int,int>& rhs)
-{
-    return lhs.first * lhs.second < rhs.first * rhs.second;
-}
-
-// Cast all rays
-static void raycast()
-{
-    static bool done_raycast = false;
-    if (done_raycast)
-        return;
-
-    // Creating all rays for first quadrant
-    // We have a considerable amount of overkill.
-    done_raycast = true;
-
-    // register perpendiculars FIRST, to make them top choice
-    // when selecting beams
-    _register_ray(geom::ray(0.5, 0.5, 0.0, 1.0));
-    _register_ray(geom::ray(0.5, 0.5, 1.0, 0.0));
-
-    // For a slope of M = y/x, every x we move on the X axis means
-    // that we move y on the y axis. We want to look at the resolution
-    // of x/y: in that case, every step on the X axis means an increase
-    // of 1 in the Y axis at the intercept point. We can assume gcd(x,y)=1,
-    // so we look at steps of 1/y.
-
-    // Changing the order a bit. We want to order by the complexity
-    // of the beam, which is log(x) + log(y) ~ xy.
-    vector<pair<int,int> > xyangles;
-    for (int xangle = 1; xangle <= LOS_MAX_ANGLE; ++xangle)
-        for (int yangle = 1; yangle <= LOS_MAX_ANGLE; ++yangle)
-        {
-            if (_gcd(xangle, yangle) == 1)
-                xyangles.emplace_back(xangle, yangle);
-        }
-
-    sort(xyangles.begin(), xyangles.end(), _complexity_lt);
-    for (auto xyangle : xyangles)
-    {
-        const int xangle = xyangle.first;
-        const int yangle = xyangle.second;
-
-        for (int intercept = 1; intercept < LOS_INTERCEPT_MULT*yangle; ++intercept)
-        {
-            double xstart = ((double)intercept) / (LOS_INTERCEPT_MULT*yangle);
-            double ystart = 0.5;
-
-            _register_ray(geom::ray(xstart, ystart, xangle, yangle));
-            // also draw the identical ray in octant 2
-            _register_ray(geom::ray(ystart, xstart, yangle, xangle));
-        }
-    }
-
-    // Now create the appropriate blockrays array
-    _create_blockrays();
-}
-
-static int _imbalance(ray_def ray, const coord_def& target)
-{
-    int imb = 0;
-    int diags = 0, straights = 0;
-    while (ray.pos() != target)
-    {
-        coord_def old = ray.pos();
-        if (!ray.advance())
-            die("can't advance ray");
-        switch ((ray.pos() - old).abs())
-        {
-        case 1:
-            diags = 0;
-            if (++straights > imb)
-                imb = straights;
-            break;
-        case 2:
-            straights = 0;
-            if (++diags > imb)
-                imb = diags;
-            break;
-        default:
-            die("ray imbalance out of range");
-        }
-    }
-    return imb;
-}
-
-void cellray::calc_params()
-{
-    coord_def trg = target();
-    imbalance = _imbalance(ray, trg);
-    first_diag = ((*this)[0].abs() == 2);
-}
-
 // Find ray in positive quadrant.
 // opc has been translated for this quadrant.
 // XXX: Allow finding ray of minimum opacity.
@@ -556,35 +149,36 @@ static bool _find_ray_se(const coord_def& target, ray_def& ray,
 
     ASSERT(target.rdist() <= LOS_RADIUS);
 
-    // Ensure the precalculations have been done.
-    raycast();
-
-    const vector<cellray> &min = min_cellrays(target);
-    ASSERT(!min.empty());
-    cellray c = min[0]; // XXX: const cellray &c ?
+    const int ti = _quadrant_index(target);
+    const los_table_cellray *min = &los_min_cellrays[los_min_cellrays_first[ti]];
+    const unsigned int num_min = los_min_cellrays_first[ti + 1]
+                                 - los_min_cellrays_first[ti];
+    ASSERT(num_min > 0);
+    const los_table_ray *fr = &los_fullrays[min[0].ray];
     unsigned int index = 0;
 
     if (cycle)
-        dprf("cycling from %d (total %u)", ray.cycle_idx, (unsigned int)min.size());
+        dprf("cycling from %d (total %u)", ray.cycle_idx, num_min);
 
     unsigned int start = cycle ? ray.cycle_idx + 1 : 0;
-    ASSERT(start <= min.size());
+    ASSERT(start <= num_min);
 
     int blocked = OPC_OPAQUE;
     for (unsigned int i = start;
-         (blocked >= OPC_OPAQUE) && (i < start + min.size()); i++)
+         (blocked >= OPC_OPAQUE) && (i < start + num_min); i++)
     {
-        index = i % min.size();
-        c = min[index];
+        index = i % num_min;
+        fr = &los_fullrays[min[index].ray];
+        const coord_def *cells = &los_ray_coords[fr->start];
         blocked = OPC_CLEAR;
         // Check all inner points.
-        for (unsigned int j = 0; j < c.end && blocked < OPC_OPAQUE; j++)
-            blocked += opc(c[j]);
+        for (unsigned int j = 0; j < min[index].end && blocked < OPC_OPAQUE; j++)
+            blocked += opc(cells[j]);
     }
     if (blocked >= OPC_OPAQUE)
         return false;
 
-    ray = c.ray;
+    ray = ray_def(geom::ray(fr->start_x, fr->start_y, fr->dir_x, fr->dir_y));
     ray.cycle_idx = index;
 
     return true;
@@ -622,12 +216,11 @@ struct opacity_trans : public opacity_func
 // If cycle is false, find the first fitting ray. If it is true,
 // assume that ray is appropriately filled in, and look for the next
 // ray. We only ever use ray.cycle_idx.
-bool find_ray(const coord_def& source, const coord_def& target,
-              ray_def& ray, const opacity_func& opc, int range,
-              bool cycle)
+static bool _find_ray_uncached(const coord_def& source,
+                               const coord_def& target, ray_def& ray,
+                               const opacity_func& opc, int range,
+                               bool cycle)
 {
-    if (target == source || !map_bounds(source) || !map_bounds(target))
-        return false;
 
     const int signx = ((target.x - source.x >= 0) ? 1 : -1);
     const int signy = ((target.y - source.y >= 0) ? 1 : -1);
@@ -652,6 +245,89 @@ bool find_ray(const coord_def& source, const coord_def& target,
     return true;
 }
 
+// Beams and tracers tend to ask for the same rays many times per turn,
+// so find_ray results are cached for the shared opacity functions below.
+// These only depend on terrain, clouds and sight-blocking monsters, all
+// of which report changes through _handle_los_change(), which starts a
+// new epoch and so drops every cached ray at once.
+static const opacity_func* const ray_cache_opacities[] =
+{
+    &opc_default, &opc_fullyopaque, &opc_no_trans, &opc_fully_no_trans,
+    &opc_solid, &opc_solid_see,
+};
+
+#define RAY_CACHE_SIZE 1024
+
+struct ray_cache_entry
+{
+    uint64_t epoch;     // 0 for unused entries
+    coord_def source;
+    coord_def target;
+    int range;
+    int opc;            // index into ray_cache_opacities
+    int cycle_idx;      // the cycle_idx cycled from, or -2 if not cycling
+    bool found;
+    ray_def ray;
+};
+
+// Per thread, so that LOS worker threads can't trample each other's
+// entries. The epoch is only moved on by LOS changes, which happen on the
+// main thread while no workers are running.
+static thread_local ray_cache_entry ray_cache[RAY_CACHE_SIZE];
+static uint64_t los_epoch = 1;
+static thread_local los_ray_cache_stats ray_cache_stats;
+
+static int _ray_cache_opacity(const opacity_func& opc)
+{
+    for (unsigned int i = 0; i < ARRAYSZ(ray_cache_opacities); ++i)
+        if (&opc == ray_cache_opacities[i])
+            return i;
+    return -1;
+}
+
+bool find_ray(const coord_def& source, const coord_def& target,
+              ray_def& ray, const opacity_func& opc, int range,
+              bool cycle)
+{
+    if (target == source || !map_bounds(source) || !map_bounds(target))
+        return false;
+
+    const int opc_idx = _ray_cache_opacity(opc);
+    if (opc_idx < 0)
+        return _find_ray_uncached(source, target, ray, opc, range, cycle);
+
+    const int cycle_idx = cycle ? ray.cycle_idx : -2;
+    const unsigned int hash = ((source.x * GYM + source.y) * 31
+                               + target.x * GYM + target.y) * 7
+                              + opc_idx + (cycle_idx + 2) * 97;
+    ray_cache_entry &e = ray_cache[hash % RAY_CACHE_SIZE];
+    if (e.epoch == los_epoch && e.source == source && e.target == target
+        && e.range == range && e.opc == opc_idx && e.cycle_idx == cycle_idx)
+    {
+        ++ray_cache_stats.hits;
+        if (e.found)
+            ray = e.ray;
+        return e.found;
+    }
+
+    ++ray_cache_stats.misses;
+    e.epoch = los_epoch;
+    e.source = source;
+    e.target = target;
+    e.range = range;
+    e.opc = opc_idx;
+    e.cycle_idx = cycle_idx;
+    e.found = _find_ray_uncached(source, target, ray, opc, range, cycle);
+    if (e.found)
+        e.ray = ray;
+    return e.found;
+}
+
+los_ray_cache_stats find_ray_cache_stats()
+{
+    return ray_cache_stats;
+}
+
 bool exists_ray(const coord_def& source, const coord_def& target,
                 const opacity_func& opc, int range)
 {
@@ -659,6 +335,42 @@ bool exists_ray(const coord_def& source, const coord_def& target,
     return find_ray(source, target, ray, opc, range);
 }
 
+// Can the opacity of the cell at offset c from a viewer affect whether
+// the viewer sees the cell at offset t? This is the case iff c is an
+// inner point of some minimal cellray to t; in particular, the ends
+// themselves never matter.
+bool los_cell_affects(const coord_def& c, const coord_def& t)
+{
+    if (t.origin() || t.rdist() > LOS_MAX_RANGE)
+        return false;
+
+    // Mirror into the positive quadrant, as in find_ray.
+    const int signx = t.x >= 0 ? 1 : -1;
+    const int signy = t.y >= 0 ? 1 : -1;
+    const coord_def qc(signx * c.x, signy * c.y);
+    const coord_def qt(signx * t.x, signy * t.y);
+
+    // Rays only move away from the origin, so every cellray to t
+    // stays in the rectangle spanned by the origin and t.
+    if (qc.origin() || qc == qt
+        || qc.x < 0 || qc.y < 0 || qc.x > qt.x || qc.y > qt.y)
+    {
+        return false;
+    }
+
+    const int ti = _quadrant_index(qt);
+    for (unsigned int i = los_min_cellrays_first[ti];
+         i < los_min_cellrays_first[ti + 1]; ++i)
+    {
+        const los_table_cellray &cr = los_min_cellrays[i];
+        const coord_def *cells = &los_ray_coords[los_fullrays[cr.ray].start];
+        for (unsigned int j = 0; j < cr.end; ++j)
+            if (cells[j] == qc)
+                return true;
+    }
+    return false;
+}
+
 // Assuming that target is in view of source, but line of
 // fire is blocked, what is it blocked by?
 dungeon_feature_type ray_blocker(const coord_def& source,
@@ -724,21 +436,115 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2)
 // proper, of the original path. We still store the original cellrays
 // fully for beam detection and such.
 // PERFORMANCE:
-// With reasonable values we have around 6000 cellrays, meaning
-// around 600Kb (75 KB) of data. This gets cut down to 700 cellrays
-// after removing duplicates. That means that we need to do
-// around 22*100*4 ~ 9,000 memory reads + writes per LOS call on a
-// 32-bit system. Not too bad.
+// With reasonable values we have around 1200 cellrays. This gets cut
+// down to about 430 cellrays after removing duplicates. The masks for
+// those fit in seven words, padded to eight (a cache line), which are
+// ORed two or four words at a time where SSE2 or AVX2 is available.
+// The surviving rays are then read off a word at a time, skipping
+// dead rays entirely.
+// All of this is computed at build time; see util/gen-los-tables.cc.
 // IMPROVEMENTS:
 // Smoke will now only block LOS after two cells of smoke. This is
 // done by updating with a second array.
 
-static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy)
+// dst |= src
+static inline void _mask_or(los_mask_word * __restrict dst,
+                            const los_mask_word * __restrict src)
+{
+#if defined(LOS_MASK_AVX2)
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; w += 4)
+    {
+        __m256i *d = reinterpret_cast<__m256i*>(dst + w);
+        const __m256i *s = reinterpret_cast<const __m256i*>(src + w);
+        _mm256_store_si256(d, _mm256_or_si256(_mm256_load_si256(d),
+                                              _mm256_load_si256(s)));
+    }
+#elif defined(LOS_MASK_SSE2)
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; w += 2)
+    {
+        __m128i *d = reinterpret_cast<__m128i*>(dst + w);
+        const __m128i *s = reinterpret_cast<const __m128i*>(src + w);
+        _mm_store_si128(d, _mm_or_si128(_mm_load_si128(d),
+                                        _mm_load_si128(s)));
+    }
+#else
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; ++w)
+        dst[w] |= src[w];
+#endif
+}
+
+// dead |= smoke & block; smoke |= block
+static inline void _mask_smoke(los_mask_word * __restrict dead,
+                               los_mask_word * __restrict smoke,
+                               const los_mask_word * __restrict block)
+{
+#if defined(LOS_MASK_AVX2)
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; w += 4)
+    {
+        __m256i *d = reinterpret_cast<__m256i*>(dead + w);
+        __m256i *s = reinterpret_cast<__m256i*>(smoke + w);
+        const __m256i b =
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(block + w));
+        const __m256i sv = _mm256_load_si256(s);
+        _mm256_store_si256(d, _mm256_or_si256(_mm256_load_si256(d),
+                                              _mm256_and_si256(sv, b)));
+        _mm256_store_si256(s, _mm256_or_si256(sv, b));
+    }
+#elif defined(LOS_MASK_SSE2)
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; w += 2)
+    {
+        __m128i *d = reinterpret_cast<__m128i*>(dead + w);
+        __m128i *s = reinterpret_cast<__m128i*>(smoke + w);
+        const __m128i b =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(block + w));
+        const __m128i sv = _mm_load_si128(s);
+        _mm_store_si128(d, _mm_or_si128(_mm_load_si128(d),
+                                        _mm_and_si128(sv, b)));
+        _mm_store_si128(s, _mm_or_si128(sv, b));
+    }
+#else
+    for (unsigned int w = 0; w < LOS_MASK_WORDS; ++w)
+    {
+        dead[w] |= smoke[w] & block[w];
+        smoke[w] |= block[w];
+    }
+#endif
+}
+
+// Index of the lowest set bit; w must be nonzero.
+static inline unsigned int _lowest_bit(los_mask_word w)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long idx;
+    _BitScanForward64(&idx, w);
+    return idx;
+#else
+    unsigned int idx = 0;
+    while (!(w & 1))
+    {
+        w >>= 1;
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+// Templated on the concrete parameter type so that the per-cell
+// opacity and bounds lookups can be inlined. The ray masks live on
+// the stack, so this may run on several threads at once as long as
+// dat is safe to read concurrently.
+template<class P>
+static void _losight_quadrant(los_grid& sh, const P& dat, int sx, int sy)
 {
-    const unsigned int num_cellrays = cellray_ends.size();
+    const unsigned int num_cellrays = LOS_NUM_CELLRAYS;
 
-    dead_rays->reset();
-    smoke_rays->reset();
+    // Which rays are blocked or have seen a smoke cloud.
+    alignas(LOS_MASK_ALIGN) los_mask_word dead_rays[LOS_MASK_WORDS];
+    alignas(LOS_MASK_ALIGN) los_mask_word smoke_rays[LOS_MASK_WORDS];
+    memset(dead_rays, 0, sizeof(dead_rays));
+    memset(smoke_rays, 0, sizeof(smoke_rays));
 
     for (quadrant_iterator qi; qi; ++qi)
     {
@@ -750,12 +556,11 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
         {
         case OPC_OPAQUE:
             // Block the appropriate rays.
-            *dead_rays |= *blockrays(*qi);
+            _mask_or(dead_rays, _blockray_mask(*qi));
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
-            *smoke_rays |= *blockrays(*qi);
+            _mask_smoke(dead_rays, smoke_rays, _blockray_mask(*qi));
             break;
         default:
             break;
@@ -763,22 +568,30 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
     }
 
     // Ray calculation done. Now work out which cells in this
-    // quadrant are visible.
-    for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
+    // quadrant are visible, visiting only the rays that are alive.
+    for (unsigned int base = 0; base < num_cellrays;
+         base += LOS_MASK_WORD_BITS)
     {
-        // make the cells seen by this ray at this point visible
-        if (!dead_rays->get(rayidx))
+        los_mask_word alive = ~dead_rays[base / LOS_MASK_WORD_BITS];
+        // Padding bits beyond the last cellray don't count.
+        if (num_cellrays - base < LOS_MASK_WORD_BITS)
+            alive &= (los_mask_word(1) << (num_cellrays - base)) - 1;
+
+        while (alive)
         {
+            const unsigned int rayidx = base + _lowest_bit(alive);
+            alive &= alive - 1;
+
             // This ray is alive, thus the end cell is visible.
-            const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
-                                          sy * cellray_ends[rayidx].y);
+            const coord_def p = coord_def(sx * los_cellray_ends[rayidx].x,
+                                          sy * los_cellray_ends[rayidx].y);
             if (dat.los_bounds(p))
                 sh(p) = true;
         }
     }
 }
 
-struct los_param_funcs : public los_param
+struct los_param_funcs final : public los_param
 {
     coord_def center;
     const opacity_func& opc;
@@ -801,16 +614,11 @@ struct los_param_funcs : public los_param
     }
 };
 
-void losight(los_grid& sh, const coord_def& center,
-             const opacity_func& opc, const circle_def& bounds)
+template<class P>
+static void _losight(los_grid& sh, const P& dat)
 {
-    const los_param& dat = los_param_funcs(center, opc, bounds);
-
     sh.init(false);
 
-    // Do precomputations if necessary.
-    raycast();
-
     const int quadrant_x[4] = {  1, -1, -1,  1 };
     const int quadrant_y[4] = {  1,  1, -1, -1 };
     for (int q = 0; q < 4; ++q)
@@ -821,6 +629,155 @@ void losight(los_grid& sh, const coord_def& center,
     sh(o) = true;
 }
 
+void losight(los_grid& sh, const coord_def& center,
+             const opacity_func& opc, const circle_def& bounds)
+{
+    _losight(sh, los_param_funcs(center, opc, bounds));
+}
+
+// A copy of the opacity of every map cell within range of any of a
+// batch of centers, so that each cell is looked up only once per batch.
+class los_opacity_snapshot
+{
+public:
+    los_opacity_snapshot(const vector<coord_def>& centers,
+                         const opacity_func& opc)
+    {
+        ASSERT(!centers.empty());
+        coord_def lo = centers[0], hi = centers[0];
+        for (const coord_def &c : centers)
+        {
+            lo.x = min(lo.x, c.x);
+            lo.y = min(lo.y, c.y);
+            hi.x = max(hi.x, c.x);
+            hi.y = max(hi.y, c.y);
+        }
+        const coord_def range(LOS_MAX_RANGE, LOS_MAX_RANGE);
+        origin = lo - range;
+        width = hi.x - lo.x + 2 * LOS_MAX_RANGE + 1;
+        const int height = hi.y - lo.y + 2 * LOS_MAX_RANGE + 1;
+        cells.assign(width * height, NUM_OPACITIES);
+
+        // Only fill the cells some center can actually see, which
+        // matters when the centers are spread out.
+        for (const coord_def &c : centers)
+            for (rectangle_iterator ri(c, LOS_MAX_RANGE); ri; ++ri)
+            {
+                if (!map_bounds(*ri))
+                    continue;
+                uint8_t &o = cells[_index(*ri)];
+                if (o == NUM_OPACITIES)
+                    o = opc(*ri);
+            }
+    }
+
+    opacity_type operator()(const coord_def& p) const
+    {
+        return static_cast<opacity_type>(cells[_index(p)]);
+    }
+
+private:
+    int _index(const coord_def& p) const
+    {
+        return (p.y - origin.y) * width + p.x - origin.x;
+    }
+
+    coord_def origin;
+    int width;
+    vector<uint8_t> cells;
+};
+
+struct los_param_snapshot final : public los_param
+{
+    coord_def center;
+    const los_opacity_snapshot& opc;
+    const circle_def& bounds;
+
+    los_param_snapshot(const coord_def& c,
+                       const los_opacity_snapshot& o, const circle_def& b)
+        : center(c), opc(o), bounds(b)
+    {
+    }
+
+    bool los_bounds(const coord_def& p) const override
+    {
+        return map_bounds(p + center) && bounds.contains(p);
+    }
+
+    opacity_type opacity(const coord_def& p) const override
+    {
+        return opc(p + center);
+    }
+};
+
+// One thread's share of a losight_many() batch.
+struct los_batch_job
+{
+    const vector<coord_def>* centers;
+    vector<los_grid>* sh;
+    const los_opacity_snapshot* opc;
+    const circle_def* bounds;
+    size_t first, last;
+};
+
+static void _losight_batch(const los_batch_job& job)
+{
+    for (size_t i = job.first; i < job.last; ++i)
+    {
+        const los_param_snapshot dat((*job.centers)[i], *job.opc,
+                                     *job.bounds);
+        _losight((*job.sh)[i], dat);
+    }
+}
+
+static void* _losight_batch_thread(void* arg)
+{
+    _losight_batch(*static_cast<los_batch_job*>(arg));
+    return nullptr;
+}
+
+void losight_many(vector<los_grid>& sh, const vector<coord_def>& centers,
+                  const opacity_func& opc, const circle_def& bounds,
+                  int threads)
+{
+    sh.resize(centers.size());
+    if (centers.empty())
+        return;
+
+    // Everything past this point only reads the snapshot and the ray
+    // tables, so the centers can be split between threads freely.
+    const los_opacity_snapshot snap(centers, opc);
+
+    const size_t njobs = max<size_t>(1, min<size_t>(threads, centers.size()));
+    vector<los_batch_job> jobs(njobs);
+    for (size_t j = 0; j < njobs; ++j)
+    {
+        jobs[j].centers = &centers;
+        jobs[j].sh = &sh;
+        jobs[j].opc = &snap;
+        jobs[j].bounds = &bounds;
+        jobs[j].first = centers.size() * j / njobs;
+        jobs[j].last = centers.size() * (j + 1) / njobs;
+    }
+
+    // The calling thread takes the first share itself. If a thread
+    // can't be started, its share is done here too.
+    vector<thread_t> workers;
+    vector<size_t> inline_jobs(1, 0);
+    for (size_t j = 1; j < njobs; ++j)
+    {
+        thread_t th;
+        if (thread_create_joinable(&th, _losight_batch_thread, &jobs[j]))
+            inline_jobs.push_back(j);
+        else
+            workers.push_back(th);
+    }
+    for (size_t j : inline_jobs)
+        _losight_batch(jobs[j]);
+    for (thread_t &th : workers)
+        thread_join(th);
+}
+
 opacity_type mons_opacity(const monster* mon, los_type how)
 {
     // no regard for LOS_ARENA
@@ -840,6 +797,7 @@ opacity_type mons_opacity(const monster* mon, los_type how)
 // has changed somewhere.
 static void _handle_los_change()
 {
+    ++los_epoch;
     invalidate_agrid();
 }
 
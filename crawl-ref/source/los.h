@@ -27,19 +27,34 @@ bool find_ray(const coord_def& source, const coord_def& target,
               int range = LOS_MAX_RANGE, bool cycle = false);
 bool exists_ray(const coord_def& source, const coord_def& target,
                 const opacity_func &opc, int range = LOS_MAX_RANGE);
+
+// How often find_ray() could answer from its cache, on this thread.
+struct los_ray_cache_stats
+{
+    unsigned long long hits = 0;
+    unsigned long long misses = 0;
+};
+los_ray_cache_stats find_ray_cache_stats();
+
 dungeon_feature_type ray_blocker(const coord_def& source, const coord_def& target);
 
 void fallback_ray(const coord_def& source, const coord_def& target,
                   ray_def& ray);
 
 bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2);
+bool los_cell_affects(const coord_def& c, const coord_def& t);
 
 typedef SquareArray<bool, LOS_MAX_RANGE> los_grid;
 
-void clear_rays_on_exit();
 void losight(los_grid& sh, const coord_def& center,
              const opacity_func &opc = opc_default,
              const circle_def &bds = BDS_DEFAULT);
+// LOS from each of centers into sh[i], reading each opacity cell only
+// once for the whole batch. With threads > 1, the centers are split
+// between that many threads; opc is only called from the caller's thread.
+void losight_many(vector<los_grid>& sh, const vector<coord_def>& centers,
+                  const opacity_func &opc = opc_default,
+                  const circle_def &bds = BDS_DEFAULT, int threads = 1);
 
 void los_actor_moved(const actor* act, const coord_def& oldpos);
 void los_monster_died(const monster* mon);
@@ -58,16 +58,61 @@ static void _save_los(los_def* los, los_type l)
         }
 }
 
-// Opacity at p has changed.
+// The cached pairs that depend on the opacity of a given cell.
+// For a cell at offset e from an anchor p (as in _lookup_globallos,
+// with 0 <= e.x <= LOS_MAX_RANGE), los_deps[e.x][e.y + o_half_y] lists
+// the entries of globallos[p.x][p.y] whose rays pass through the cell,
+// as indices into the flattened halflos_t. Pairs are stored only once,
+// but may have been computed from either end, so both directions count.
+typedef vector<uint8_t> losdeps_t[LOS_MAX_RANGE+1][2*LOS_MAX_RANGE+1];
+static losdeps_t los_deps;
+
+static void _init_los_deps()
+{
+    COMPILE_CHECK(sizeof(halflos_t) <= 256);
+
+    static bool done = false;
+    if (done)
+        return;
+    done = true;
+
+    for (int ex = 0; ex <= LOS_MAX_RANGE; ex++)
+        for (int ey = -LOS_MAX_RANGE; ey <= LOS_MAX_RANGE; ey++)
+        {
+            const coord_def e(ex, ey);
+            for (int hx = 0; hx <= LOS_MAX_RANGE; hx++)
+                for (int hy = 0; hy <= 2*LOS_MAX_RANGE; hy++)
+                {
+                    const coord_def d(hx - o_half_x, hy - o_half_y);
+                    if (d < coord_def(0, 0))
+                        continue;
+                    if (los_cell_affects(e, d) || los_cell_affects(e - d, -d))
+                    {
+                        los_deps[ex][ey + o_half_y].push_back(
+                            hx * (2*LOS_MAX_RANGE+1) + hy);
+                    }
+                }
+        }
+}
+
+// Opacity at p has changed. Only forget about the pairs whose rays
+// pass through p; all of them have their lower end (the anchor) in
+// the half-square to the left of p.
 void invalidate_los_around(const coord_def& p)
 {
+    _init_los_deps();
+
     int x1 = max(p.x - LOS_MAX_RANGE, 0);
     int y1 = max(p.y - LOS_MAX_RANGE, 0);
     int x2 = min(p.x, GXM - 1);
     int y2 = min(p.y + LOS_MAX_RANGE, GYM - 1);
     for (int y = y1; y <= y2; y++)
         for (int x = x1; x <= x2; x++)
-            memset(globallos[x][y], 0, sizeof(halflos_t));
+        {
+            losfield_t* flags = &globallos[x][y][0][0];
+            for (uint8_t i : los_deps[p.x - x][p.y - y + o_half_y])
+                flags[i] = 0;
+        }
 }
 
 void invalidate_los()
@@ -113,6 +158,56 @@ static void _update_globallos_at(const coord_def& p, los_type l)
     }
 }
 
+static const opacity_func& _los_type_opacity(los_type l)
+{
+    switch (l)
+    {
+    case LOS_DEFAULT:   return opc_default;
+    case LOS_NO_TRANS:  return opc_no_trans;
+    case LOS_SOLID:     return opc_solid;
+    case LOS_SOLID_SEE: return opc_solid_see;
+    default:
+        die("invalid opacity");
+    }
+}
+
+// Fill the cache for each of centers in one go. Only pairs that aren't
+// known already are written, so lookups give the same answers as if
+// the centers had been filled in lazily (LOS is symmetric).
+void prefetch_los(const vector<coord_def>& centers, los_type l, int threads)
+{
+    vector<coord_def> todo;
+    for (const coord_def &c : centers)
+    {
+        const losfield_t* flags = _lookup_globallos(c, c);
+        if (flags && !(*flags & (l << LOS_KNOWN))
+            && find(todo.begin(), todo.end(), c) == todo.end())
+        {
+            todo.push_back(c);
+        }
+    }
+    if (todo.empty())
+        return;
+
+    vector<los_grid> grids;
+    losight_many(grids, todo, _los_type_opacity(l), BDS_DEFAULT, threads);
+
+    for (size_t i = 0; i < todo.size(); ++i)
+    {
+        for (rectangle_iterator ri(todo[i], LOS_MAX_RANGE); ri; ++ri)
+        {
+            losfield_t* flags = _lookup_globallos(todo[i], *ri);
+            if (!flags || (*flags & (l << LOS_KNOWN)))
+                continue;
+            *flags |= l << LOS_KNOWN;
+            if (grids[i](*ri - todo[i]))
+                *flags |= l;
+            else
+                *flags &= ~l;
+        }
+    }
+}
+
 bool cell_see_cell(const coord_def& p, const coord_def& q, los_type l)
 {
     if (l == LOS_NONE)
@@ -6,3 +6,5 @@ void invalidate_los_around(const coord_def& p);
 void invalidate_los();
 
 bool cell_see_cell(const coord_def& p, const coord_def& q, los_type l);
+void prefetch_los(const vector<coord_def>& centers, los_type l,
+                  int threads = 1);
@@ -398,7 +398,7 @@ int determine_nice_weapon_plusses(int item_level)
 
 void set_artefact_brand(item_def &item, int brand)
 {
-    item.props[ARTEFACT_PROPS_KEY].get_vector()[ARTP_BRAND].get_short() = brand;
+    item.art_props[ARTP_BRAND] = brand;
 }
 
 static void _generate_weapon_item(item_def& item, bool allow_uniques,
@@ -11,6 +11,7 @@
 #include "areas.h"
 #include "arena.h"
 #include "attitude-change.h"
+#include "beam.h"
 #include "bloodspatter.h"
 #include "cloud.h"
 #include "colour.h"
@@ -44,12 +45,14 @@
 #include "mon-cast.h"
 #include "mon-death.h"
 #include "mon-movetarget.h"
+#include "mon-pathfind.h"
 #include "mon-place.h"
 #include "mon-poly.h"
 #include "mon-project.h"
 #include "mon-speak.h"
 #include "mon-tentacle.h"
 #include "nearby-danger.h"
+#include "options.h"
 #include "religion.h"
 #include "shout.h"
 #include "spl-book.h"
@@ -1401,6 +1404,8 @@ static int _tentacle_move_speed(monster_type type)
 
 static void _pre_monster_move(monster& mons)
 {
+    // Types special-cased here that act even while asleep are listed in
+    // _mons_acts_in_sleep().
     mons.hit_points = min(mons.max_hit_points, mons.hit_points);
 
     if (mons.type == MONS_SPATIAL_MAELSTROM
@@ -1624,6 +1629,7 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
 void handle_monster_move(monster* mons)
 {
     ASSERT(mons); // XXX: change to monster &mons
+    // As in _pre_monster_move(), keep _mons_acts_in_sleep() up to date.
     const monsterentry* entry = get_monster_data(mons->type);
     if (!entry)
         return;
@@ -1643,6 +1649,10 @@ void handle_monster_move(monster* mons)
     if (!mons->has_action_energy())
         return;
 
+    // Tracers fired while deciding this move may be reused within it, but
+    // anything may have changed by the next monster's.
+    tracer_cache_scope tracer_cache;
+
     if (!disabled)
         move_solo_tentacle(mons);
 
@@ -2198,6 +2208,7 @@ static void _torpor_snail_slow(monster* mons)
 
 static void _post_monster_move(monster* mons)
 {
+    // As in _pre_monster_move(), keep _mons_acts_in_sleep() up to date.
     if (invalid_monster(mons))
         return;
 
@@ -2300,8 +2311,11 @@ static void _clear_monster_flags()
     // monsters get their actions in the next round.
     // Also clear one-turn deep sleep flag.
     // XXX: MF_JUST_SLEPT only really works for player-cast hibernation.
-    for (auto &mons : menv_real)
-        mons.flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
+    for (int i = env.mons_in_use.next(0); i < MAX_MONSTERS;
+         i = env.mons_in_use.next(i + 1))
+    {
+        env.mons[i].flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
+    }
 }
 
 /**
@@ -2359,6 +2373,73 @@ static void _display_just_seen()
     mons_reset_just_seen();
 }
 
+// Monster types that do something on their turn even while asleep: those
+// special-cased by type in _pre_monster_move(), handle_monster_move() and
+// _post_monster_move() ahead of, or regardless of, any sleep check. There's
+// no monster flag for this, so any such case added there must be added here
+// too, or the monster will be skipped as dormant.
+static bool _mons_acts_in_sleep(monster_type mc)
+{
+    switch (mc)
+    {
+    case MONS_SPATIAL_MAELSTROM:
+    case MONS_SNAPLASHER_VINE:
+    case MONS_BALL_LIGHTNING:
+    case MONS_FOXFIRE:
+    case MONS_BATTLESPHERE:
+    case MONS_FULMINANT_PRISM:
+    case MONS_BOULDER:
+    case MONS_TIAMAT:
+    case MONS_SIXFIRHY:
+    case MONS_JIANGSHI:
+    case MONS_ANCIENT_ZYME:
+    case MONS_TORPOR_SNAIL:
+    case MONS_WATER_NYMPH:
+    case MONS_ELEMENTAL_WELLSPRING:
+    case MONS_NORRIS:
+    case MONS_GUARDIAN_GOLEM:
+    case MONS_RAKSHASA:
+    case MONS_GLOWING_SHAPESHIFTER:
+    case MONS_SHAPESHIFTER:
+        return true;
+    default:
+        return mons_is_projectile(mc)
+               || mons_is_tentacle_or_tentacle_segment(mc);
+    }
+}
+
+/**
+ * Is this monster dormant: asleep out of the player's sight, with nothing
+ * in or around it that would need its turn?
+ *
+ * Such a monster would only gain and spend energy, so handle_monsters()
+ * skips it entirely. Anything that could change that (noise or the player
+ * waking it, damage, an enchantment, a cloud, the player coming into view)
+ * makes this false again by the next turn, so there's nothing to catch up
+ * on when it resumes: it can't heal and has no timers running. It keeps
+ * whatever energy it had when it went dormant.
+ */
+static bool _monster_is_dormant(const monster& mons)
+{
+    return mons.behaviour == BEH_SLEEP
+           && mons.attitude == ATT_HOSTILE
+           && mons.foe == MHITNOT
+           && mons.foe_memory <= 0
+           && mons.hit_points == mons.max_hit_points
+           && mons.enchantments.empty()
+           && mons.speed > 0
+           && !_mons_acts_in_sleep(mons.type)
+           && !mons.is_constricting()
+           && !mons.is_constricted()
+           && !you.see_cell(mons.pos())
+           && !cloud_at(mons.pos())
+           && env.grid(mons.pos()) != DNGN_TOXIC_BOG
+           && !(env.level_state & (LSTATE_SLIMY_WALL | LSTATE_ICY_WALL))
+           // Jiyva and Fedhas get one try at converting it first.
+           && (testbits(mons.flags, MF_ATT_CHANGE_ATTEMPT)
+               || !mons_is_slime(mons) && !fedhas_neutralises(mons));
+}
+
 /**
  * Get all monsters to make an action, if they can/want to.
  *
@@ -2366,13 +2447,31 @@ static void _display_just_seen()
  */
 void handle_monsters(bool with_noise)
 {
+    reset_flow_fields();
+
+    vector<coord_def> acting;
     for (monster_iterator mi; mi; ++mi)
     {
+        if (_monster_is_dormant(**mi))
+            continue;
+
         _pre_monster_move(**mi);
         if (!invalid_monster(*mi) && mi->alive() && mi->has_action_energy())
+        {
             monster_queue.emplace(*mi, mi->speed_increment);
+            acting.push_back(mi->pos());
+        }
     }
 
+    // Nearly every monster starts its turn by looking around, which is
+    // read-only, so its LOS can be prefetched for all of them up front on
+    // several threads. Everything else about their turns, deciding what
+    // to do included, still happens one at a time in queue order, and
+    // anything they change is invalidated in the LOS cache as usual, so
+    // the game plays out exactly as it would have.
+    if (Options.los_prefetch_threads > 1)
+        prefetch_los(acting, LOS_DEFAULT, Options.los_prefetch_threads);
+
     int tries = 0; // infinite loop protection, shouldn't be ever needed
     while (!monster_queue.empty())
     {
@@ -2144,9 +2144,9 @@ static void _set_door(set<coord_def> door, dungeon_feature_type feat)
 static int _tension_door_closed(set<coord_def> door,
                                 dungeon_feature_type old_feat)
 {
-    // this unwind is a bit heavy, but because out-of-los clouds dissipate
-    // instantly, they can be wiped out by these door tests.
-    unwind_var<map<coord_def, cloud_struct>> cloud_state(env.cloud);
+    // closing the door wipes out any clouds in the doorway, so put them back
+    // afterwards.
+    cloud_grid::saved_cells door_clouds(env.cloud, door);
     _set_door(door, DNGN_CLOSED_DOOR);
     const int new_tension = get_tension(GOD_NO_GOD);
     _set_door(door, old_feat);
@@ -7497,9 +7497,8 @@ ai_action::goodness monster_spell_goodness(monster* mon, spell_type spell)
             tracer.target = foe->pos();
             tracer.range  = LOS_RADIUS;
             tracer.hit    = AUTOMATIC_HIT;
-            fire_tracer(mon, tracer);
 
-            actor* act = actor_at(tracer.path_taken.back());
+            actor* act = actor_at(fire_tracer(mon, tracer).stop);
             // XX does this handle multiple actors?
             return ai_action::good_or_bad(!act || !mons_aligned(mon, act));
         }
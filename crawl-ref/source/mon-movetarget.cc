@@ -211,6 +211,21 @@ bool try_pathfind(monster* mon)
          mon->name(DESC_PLAIN).c_str(), mon->pos().x, mon->pos().y,
          targpos.x, targpos.y, range);
 #endif
+    // Hostile packs chasing the same foe share a distance map rather than
+    // each searching for a path of their own.
+    if (!mon->friendly())
+    {
+        const coord_def step = flow_field_step(mon, targpos, range);
+        if (!step.origin())
+        {
+            mon->travel_path.clear();
+            mon->travel_path.push_back(step);
+            mon->target = step;
+            mon->travel_target = MTRAV_FOE;
+            return true;
+        }
+    }
+
     monster_pathfind mp;
     mp.set_range(range);
 
@@ -2,12 +2,16 @@
 
 #include "mon-pathfind.h"
 
+#include <memory>
+
 #include "directn.h"
 #include "env.h"
 #include "los.h"
+#include "maybe-bool.h"
 #include "misc.h"
 #include "mon-movetarget.h"
 #include "mon-place.h"
+#include "mon-util.h"
 #include "religion.h"
 #include "state.h"
 #include "terrain.h"
@@ -29,6 +33,122 @@
 // then there's no path that matches the requirements fed into monster_pathfind.
 // (These requirements are usually preference of habitat of a specific monster
 // or a limit of the distance between start and any grid on the path.)
+//
+// The hash is a monotone radix heap: the estimated totals pulled from it
+// never decrease, since every step costs at least one and the estimate
+// changes by at most one per step. The search state lives in buffers that
+// are recycled between searches rather than cleared; see pathfind_cell.
+
+// What a search knows about a single grid. A cell whose generation is not
+// the current one hasn't been looked at yet in this search, so starting a
+// search only needs to bump the generation.
+struct pathfind_cell
+{
+    unsigned int generation;
+    // Distance from start to this point.
+    int dist;
+    // Where we came from on a shortest path, as a Compass direction.
+    int prev;
+    maybe_bool traversable;
+};
+
+// Radix heap of positions keyed by estimated total path length. An entry
+// is kept in the bucket for the highest bit in which its key differs from
+// the last key pulled, and only moves to lower buckets when a bucket has
+// to be split up to find the next smallest key. Entries with the same key
+// always share a bucket and keep their relative order, so they come out
+// last in, first out, just like the old per-length vectors did.
+class pathfind_radix_heap
+{
+public:
+    pathfind_radix_heap() : last(0) { }
+
+    void clear()
+    {
+        for (vector<entry> &b : buckets)
+            b.clear();
+        last = 0;
+    }
+
+    void push(int key, const coord_def &p)
+    {
+        ASSERT(key >= last);
+        buckets[_bucket(key)].push_back({key, p});
+    }
+
+    bool pop(int &key, coord_def &p)
+    {
+        if (buckets[0].empty())
+        {
+            int b = 1;
+            while (b < NUM_BUCKETS && buckets[b].empty())
+                b++;
+            if (b == NUM_BUCKETS)
+                return false;
+
+            vector<entry> &from = buckets[b];
+            last = from[0].key;
+            for (const entry &e : from)
+                last = min(last, e.key);
+            // Everything here now goes to a lower bucket.
+            for (const entry &e : from)
+                buckets[_bucket(e.key)].push_back(e);
+            from.clear();
+        }
+
+        const entry &e = buckets[0].back();
+        key = e.key;
+        p = e.pos;
+        buckets[0].pop_back();
+        return true;
+    }
+
+private:
+    struct entry
+    {
+        int key;
+        coord_def pos;
+    };
+
+    static const int NUM_BUCKETS = 33;
+
+    int _bucket(int key) const
+    {
+        int b = 0;
+        for (unsigned int diff = key ^ last; diff; diff >>= 1)
+            b++;
+        return b;
+    }
+
+    vector<entry> buckets[NUM_BUCKETS];
+    int last;
+};
+
+struct pathfind_buffers
+{
+    pathfind_buffers() : cells(), generation(0) { }
+
+    pathfind_cell cells[GXM][GYM];
+    unsigned int generation;
+    pathfind_radix_heap hash;
+};
+
+// Buffers not currently used by any monster_pathfind. Searches rarely
+// overlap, so this seldom holds more than one set.
+static thread_local vector<unique_ptr<pathfind_buffers>> free_buffers;
+
+static pathfind_cell &_cell(pathfind_buffers &buf, const coord_def &p)
+{
+    pathfind_cell &c = buf.cells[p.x][p.y];
+    if (c.generation != buf.generation)
+    {
+        c.generation  = buf.generation;
+        c.dist        = INFINITE_DISTANCE;
+        c.prev        = 0;
+        c.traversable = maybe_bool::maybe;
+    }
+    return c;
+}
 
 int mons_tracking_range(const monster* mon)
 {
@@ -64,12 +184,20 @@ int mons_tracking_range(const monster* mon)
 monster_pathfind::monster_pathfind()
     : mons(nullptr), start(), target(), pos(), allow_diagonals(true),
       traverse_unmapped(false), range(0), min_length(0), max_length(0),
-      dist(), prev(), hash(), traversable_cache()
+      buf(nullptr)
 {
+    if (free_buffers.empty())
+        buf = new pathfind_buffers;
+    else
+    {
+        buf = free_buffers.back().release();
+        free_buffers.pop_back();
+    }
 }
 
 monster_pathfind::~monster_pathfind()
 {
+    free_buffers.emplace_back(buf);
 }
 
 void monster_pathfind::set_range(int r)
@@ -80,7 +208,8 @@ void monster_pathfind::set_range(int r)
 
 coord_def monster_pathfind::next_pos(const coord_def &c) const
 {
-    return c + Compass[prev[c.x][c.y]];
+    const pathfind_cell &cell = buf->cells[c.x][c.y];
+    return c + Compass[cell.generation == buf->generation ? cell.prev : 0];
 }
 
 // The main method in the monster_pathfind class.
@@ -136,14 +265,9 @@ bool monster_pathfind::start_pathfind(bool msg)
     //       a wall.
 
     max_length = min_length = grid_distance(pos, target);
-    for (int i = 0; i < GXM; i++)
-        for (int j = 0; j < GYM; j++)
-        {
-            dist[i][j] = INFINITE_DISTANCE;
-            traversable_cache[i][j] = maybe_bool::maybe;
-        }
 
-    dist[pos.x][pos.y] = 0;
+    new_search();
+    _cell(*buf, pos).dist = 0;
 
     bool success = false;
     do
@@ -170,6 +294,20 @@ bool monster_pathfind::start_pathfind(bool msg)
     while (true);
 }
 
+// Forget the last search. Only when the generation wraps around do the
+// cells really have to be cleared.
+void monster_pathfind::new_search()
+{
+    if (++buf->generation == 0)
+    {
+        for (int i = 0; i < GXM; i++)
+            for (int j = 0; j < GYM; j++)
+                buf->cells[i][j].generation = 0;
+        buf->generation = 1;
+    }
+    buf->hash.clear();
+}
+
 // Returns true as soon as we encounter the target.
 bool monster_pathfind::calc_path_to_neighbours()
 {
@@ -213,8 +351,8 @@ bool monster_pathfind::calc_path_to_neighbours()
         if (range && estimated_cost(npos) > range)
             continue;
 
-        distance = dist[pos.x][pos.y] + travel_cost(npos);
-        old_dist = dist[npos.x][npos.y];
+        distance = _cell(*buf, pos).dist + travel_cost(npos);
+        old_dist = _cell(*buf, npos).dist;
 
         // Also bail out if this would make the path longer than twice the
         // allowed distance from the target. (This factor may need tuning.)
@@ -256,7 +394,8 @@ bool monster_pathfind::calc_path_to_neighbours()
             }
 
             // Update distance start->pos.
-            dist[npos.x][npos.y] = distance;
+            pathfind_cell &ncell = _cell(*buf, npos);
+            ncell.dist = distance;
 
             // Set backtracking information.
             // Converts the Compass direction to its counterpart.
@@ -264,7 +403,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             //      7  .  3   ==>   3  .  7       e.g. (3 + 4) % 8          = 7
             //      6  5  4         2  1  0            (7 + 4) % 8 = 11 % 8 = 3
 
-            prev[npos.x][npos.y] = (dir + 4) % 8;
+            ncell.prev = (dir + 4) % 8;
 
             // Are we finished?
             if (npos == target)
@@ -279,34 +418,30 @@ bool monster_pathfind::calc_path_to_neighbours()
     return false;
 }
 
-// Starting at known min_length (minimum total estimated path distance), check
-// the hash for existing vectors, then pick the last entry of the first vector
-// that matches. Update min_length, if necessary.
+// Pull the position with the shortest total estimated path distance from
+// the hash. Among those, this is the last one pushed, as it's most likely
+// to be close to the target. Update min_length, if necessary.
 bool monster_pathfind::get_best_position()
 {
-    for (int i = min_length; i <= max_length; i++)
+    int total;
+    coord_def npos;
+    while (buf->hash.pop(total, npos))
     {
-        if (!hash[i].empty())
-        {
-            if (i > min_length)
-                min_length = i;
+        // Positions whose distance improved were pushed again with the
+        // smaller total; skip the outdated entries.
+        if (total != _cell(*buf, npos).dist + estimated_cost(npos))
+            continue;
 
-            vector<coord_def> &vec = hash[i];
-            // Pick the last position pushed into the vector as it's most
-            // likely to be close to the target.
-            pos = vec[vec.size()-1];
-            vec.pop_back();
+        pos = npos;
+        if (total > min_length)
+            min_length = total;
 
 #ifdef DEBUG_PATHFIND
-            mprf("Returning (%d, %d) as best pos with total dist %d.",
-                 pos.x, pos.y, min_length);
+        mprf("Returning (%d, %d) as best pos with total dist %d.",
+             pos.x, pos.y, min_length);
 #endif
 
-            return true;
-        }
-#ifdef DEBUG_PATHFIND
-        mprf("No positions for path length %d.", i);
-#endif
+        return true;
     }
 
     // Nothing found? Then there's no path! :(
@@ -330,7 +465,7 @@ vector<coord_def> monster_pathfind::backtrack()
     int dir;
     do
     {
-        dir = prev[pos.x][pos.y];
+        dir = _cell(*buf, pos).prev;
         pos = pos + Compass[dir];
         ASSERT_IN_BOUNDS(pos);
 #ifdef DEBUG_PATHFIND
@@ -394,9 +529,10 @@ vector<coord_def> monster_pathfind::calc_waypoints()
 
 bool monster_pathfind::traversable_memoized(const coord_def& p)
 {
-    if (traversable_cache[p.x][p.y] == maybe_bool::maybe)
-        traversable_cache[p.x][p.y] = traversable(p);
-    return bool(traversable_cache[p.x][p.y]);
+    pathfind_cell &c = _cell(*buf, p);
+    if (c.traversable == maybe_bool::maybe)
+        c.traversable = traversable(p);
+    return bool(c.traversable);
 }
 
 bool monster_pathfind::traversable(const coord_def& p)
@@ -495,24 +631,195 @@ int monster_pathfind::estimated_cost(coord_def p)
 
 void monster_pathfind::add_new_pos(coord_def npos, int total)
 {
-    hash[total].push_back(npos);
+    buf->hash.push(total, npos);
 }
 
 void monster_pathfind::update_pos(coord_def npos, int total)
 {
-    // Find hash position of old distance and delete it,
-    // then call_add_new_pos.
-    int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
+    // The entry with the old total stays in the hash, and is skipped by
+    // get_best_position() once the new distance has been stored.
+    add_new_pos(npos, total);
+}
 
-    vector<coord_def> &vec = hash[old_total];
-    for (unsigned int i = 0; i < vec.size(); i++)
+/////////////////////////////////////////////////////////////////////////////
+// Flow fields
+//
+// When a whole pack is after the same foe, running the above search for
+// each of them finds much the same paths over and over. Instead, monsters
+// that move alike share a single distance map to the spot they're after,
+// flooded outwards from there by Dijkstra's algorithm. A monster then only
+// needs to step to the neighbour its cell points at. The maps are thrown
+// away at the start of each turn and whenever terrain changes, and only
+// built when some monster asks for one.
+
+// Everything traversable() and travel_cost() look at about the monster,
+// so that any two monsters with the same flow_class would flood the same
+// field. Habitat, door use and the thorn hunter hack follow from the type
+// (and the base type, for zombies and draconians) plus flight; floundering
+// also depends on body size, which varies for ghosts. Attitude and whether
+// a friend can see you decide which traps it shuns and what they cost.
+struct flow_class
+{
+    monster_type type;
+    monster_type base_type;
+    mon_attitude_type attitude;
+    bool airborne;
+    size_type size;
+    bool wont_attack;
+    bool friend_sees_you;
+    bool doors;
+    bool flounders;
+
+    bool operator==(const flow_class &other) const
     {
-        if (vec[i] == npos)
+        return type == other.type && base_type == other.base_type
+               && attitude == other.attitude && airborne == other.airborne
+               && size == other.size && wont_attack == other.wont_attack
+               && friend_sees_you == other.friend_sees_you
+               && doors == other.doors && flounders == other.flounders;
+    }
+};
+
+static flow_class _flow_class(const monster* mon)
+{
+    flow_class cls;
+    cls.type = mon->type;
+    cls.base_type = mons_base_type(*mon);
+    cls.attitude = mon->attitude;
+    cls.airborne = mon->airborne();
+    cls.size = mon->body_size(PSIZE_BODY);
+    cls.wont_attack = mon->wont_attack();
+    cls.friend_sees_you = mon->friendly() && mon->can_see(you);
+    cls.doors = mon->can_pass_through_feat(DNGN_FLOOR)
+                && (mons_can_open_door(*mon, mon->pos())
+                    || mons_can_eat_door(*mon, mon->pos())
+                    || mons_can_destroy_door(*mon, mon->pos()));
+    cls.flounders = mons_primary_habitat(*mon) != HT_WATER
+                    && mons_habitat(*mon, true) != HT_AMPHIBIOUS
+                    && mon->ground_level();
+    return cls;
+}
+
+class monster_flow_field : public monster_pathfind
+{
+public:
+    monster_flow_field(const monster* mon, const coord_def& dest, int r,
+                       const flow_class &c)
+        : cls(c), place(level_id::current())
+    {
+        mons = mon;
+        target = dest;
+        range = r;
+    }
+
+    void flood();
+    coord_def step(const monster* mon);
+
+    const coord_def& destination() const { return target; }
+    int search_range() const { return range; }
+
+    const flow_class cls;
+    const level_id place;
+};
+
+// Fill in the distance from each cell to the target, and which way to go
+// from there. As in calc_path_to_neighbours(), nothing further than range
+// from the target, or on a path longer than twice that, is considered.
+void monster_flow_field::flood()
+{
+    new_search();
+    _cell(*buf, target).dist = 0;
+    add_new_pos(target, 0);
+
+    int distance;
+    coord_def npos;
+    while (buf->hash.pop(distance, npos))
+    {
+        if (distance != _cell(*buf, npos).dist)
+            continue;
+
+        for (int dir = 0; dir < 8; ++dir)
         {
-            vec.erase(vec.begin() + i);
+            // The cell we'd be stepping from into npos.
+            pos = npos + Compass[dir];
+            if (!in_bounds(pos)
+                || range && grid_distance(pos, target) > range
+                || !traversable_memoized(pos))
+            {
+                continue;
+            }
+
+            const int total = distance + travel_cost(npos);
+            if (range && total > range * 2)
+                continue;
+
+            pathfind_cell &c = _cell(*buf, pos);
+            if (total < c.dist)
+            {
+                c.dist = total;
+                c.prev = (dir + 4) % 8;
+                add_new_pos(pos, total);
+            }
+        }
+    }
+
+    // The monster we flooded for might not be around for long.
+    mons = nullptr;
+}
+
+// Where should mon go next? Returns the origin if the field doesn't know,
+// or the way it points isn't open to this particular monster.
+coord_def monster_flow_field::step(const monster* mon)
+{
+    const pathfind_cell &c = _cell(*buf, mon->pos());
+    if (c.dist == INFINITE_DISTANCE || mon->pos() == target)
+        return coord_def();
+
+    const coord_def next = mon->pos() + Compass[c.prev];
+    if (next == target)
+        return next;
+
+    mons = mon;
+    const bool ok = traversable(next);
+    mons = nullptr;
+    return ok ? next : coord_def();
+}
+
+static vector<unique_ptr<monster_flow_field>> flow_fields;
+
+// Plenty for a turn; beyond this the oldest maps are dropped.
+#define MAX_FLOW_FIELDS 16
+
+coord_def flow_field_step(const monster* mon, coord_def dest, int range)
+{
+    const flow_class cls = _flow_class(mon);
+    const level_id here = level_id::current();
+
+    monster_flow_field *field = nullptr;
+    for (const auto &f : flow_fields)
+    {
+        if (f->destination() == dest && f->search_range() == range
+            && f->place == here
+            && f->cls == cls)
+        {
+            field = f.get();
             break;
         }
     }
 
-    add_new_pos(npos, total);
+    if (!field)
+    {
+        if (flow_fields.size() >= MAX_FLOW_FIELDS)
+            flow_fields.erase(flow_fields.begin());
+        flow_fields.emplace_back(new monster_flow_field(mon, dest, range, cls));
+        field = flow_fields.back().get();
+        field->flood();
+    }
+
+    return field->step(mon);
+}
+
+void reset_flow_fields()
+{
+    flow_fields.clear();
 }
@@ -2,22 +2,27 @@
 
 #include "coord-def.h"
 #include "defines.h"
-#include "fixedvector.h"
-#include "maybe-bool.h"
-#include <unordered_map>
 #include <vector>
 
 using std::vector;
 
 class monster;
+struct pathfind_buffers;
 
 int mons_tracking_range(const monster* mon);
 
+// Which way mon should step to get to dest, using a distance map shared
+// with other monsters that move the same way; the origin if there's none.
+coord_def flow_field_step(const monster* mon, coord_def dest, int range);
+// Drop all shared distance maps, when a new turn starts or terrain changes.
+void reset_flow_fields();
+
 class monster_pathfind
 {
 public:
     monster_pathfind();
     virtual ~monster_pathfind();
+    DISALLOW_COPY_AND_ASSIGN(monster_pathfind);
 
     // public methods
     void set_range(int r);
@@ -43,6 +48,7 @@ protected:
     void add_new_pos(coord_def pos, int total);
     void update_pos(coord_def pos, int total);
     bool get_best_position();
+    void new_search();
 
     // The monster trying to find a path.
     const monster* mons;
@@ -69,12 +75,7 @@ protected:
     int min_length;
     int max_length;
 
-    // The array of distances from start to any already tried point.
-    int dist[GXM][GYM];
-    // An array to store where we came from on a given shortest path.
-    int prev[GXM][GYM];
-
-    FixedVector<vector<coord_def>, GXM * GYM> hash;
-
-    maybe_bool traversable_cache[GXM][GYM];
+    // Distances, backtracking information and the search frontier,
+    // borrowed from a per-thread pool for the lifetime of this object.
+    pathfind_buffers *buf;
 };
@@ -841,6 +841,7 @@ monster* get_free_monster()
         if (mons.type == MONS_NO_MONSTER)
         {
             mons.reset();
+            env.mons_in_use.set(mons.mindex(), true);
             return &mons;
         }
 
@@ -170,6 +170,12 @@ void monster::reset()
     // Just for completeness.
     speed           = 0;
     colour         = COLOUR_INHERIT;
+
+    if (mindex() >= 0 && mindex() < MAX_MONSTERS)
+    {
+        env.mons_in_use.set(mindex(), false);
+        env.mons_pos[mindex()] = position;
+    }
 }
 
 void monster::init_with(const monster& mon)
@@ -214,6 +220,13 @@ void monster::init_with(const monster& mon)
         ghost.reset(new ghost_demon(*mon.ghost));
     else
         ghost.reset(nullptr);
+
+    if (mindex() >= 0 && mindex() < MAX_MONSTERS)
+    {
+        if (type != MONS_NO_MONSTER)
+            env.mons_in_use.set(mindex(), true);
+        env.mons_pos[mindex()] = position;
+    }
 }
 
 uint32_t monster::last_client_id = 0;
@@ -2574,6 +2587,13 @@ void monster::set_position(const coord_def &c)
     }
 
     actor::set_position(c);
+    sync_hot_position();
+}
+
+void monster::sync_hot_position() const
+{
+    if (mindex() >= 0 && mindex() < MAX_MONSTERS)
+        env.mons_pos[mindex()] = position;
 }
 
 void monster::moveto(const coord_def& c, bool clear_net)
@@ -160,6 +160,8 @@ public:
     void self_destruct() override;
 
     void set_position(const coord_def &c) override;
+    // Copy position to env.mons_pos, after changing it directly.
+    void sync_hot_position() const;
     void moveto(const coord_def& c, bool clear_net = true) override;
     bool move_to_pos(const coord_def &newpos, bool clear_net = true,
                      bool force = false) override;
@@ -164,6 +164,7 @@ item_def* newgame_make_item(object_class_type base,
         && you.equip[get_item_slot(item)] == -1)
     {
         you.equip[get_item_slot(item)] = slot;
+        you.invalidate_artefact_totals();
     }
 
     if (item.base_type == OBJ_MISSILES)
@@ -580,6 +581,9 @@ static void _setup_generic(const newgame_def& ng,
     else
         you.save = new package(get_savedir_filename(you.your_name).c_str(),
                                true, true);
+    // Falls back to the default if this build can't do it.
+    you.save->set_codec(Options.save_compression);
+    you.save->set_background(Options.background_save);
 
     // pregen temple -- it's quick and easy, and this prevents a popup from
     // happening. This needs to happen after you.save is created.
@@ -115,7 +115,8 @@ public:
     // Propagate noise from the noise sources registered.
     void propagate_noise();
 
-    // Clear all noise from the noise grid.
+    // Clear all noise from the noise grid. Only cells noise has reached
+    // since the last reset are touched.
     void reset();
 
     bool dirty() const { return !noises.empty(); }
@@ -140,8 +141,16 @@ private:
                                        const coord_def &affected_position,
                                        const noise_t &noise) const;
 
+    void queue_cell(const coord_def &pos);
+
 private:
     FixedArray<noise_cell, GXM, GYM> cells;
     vector<noise_t> noises;
     int affected_actor_count;
+
+    // The bounding box of cells with noise in them.
+    coord_def noisy_min, noisy_max;
+
+    // Cells waiting to propagate noise, by intensity; see propagate_noise().
+    vector<vector<coord_def>> buckets;
 };
@@ -24,6 +24,7 @@
 #include "newgame-def.h"
 #include "pattern.h"
 #include "rc-line-type.h"
+#include "save-codec-type.h"
 #include "screen-mode.h"
 #include "skill-focus-mode.h"
 #include "slot-select-mode.h"
@@ -614,6 +615,8 @@ public:
     bool        arena_dump_msgs_all;
     bool        arena_list_eq;
 
+    int         los_prefetch_threads; // Threads prefetching monster LOS
+
     vector<message_filter> force_more_message;
     vector<message_filter> flash_screen_message;
     vector<text_pattern> confirm_action;
@@ -693,6 +696,8 @@ public:
     bool        single_column_item_menus;
 
     bool        dump_on_save;       // Automatically dump character when saving.
+    save_codec  save_compression;   // How to compress newly written chunks.
+    bool        background_save;    // Compress and write saves on a thread.
     kill_dump_options dump_kill_places;   // How to dump place information for kills.
     int         dump_message_count; // How many old messages to dump
 
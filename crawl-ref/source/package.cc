@@ -16,6 +16,11 @@ Notes:
 * Readers always get the last complete (but not necessarily committed) write
   (ie, READ_UNCOMMITTED) at the time they started; it is safe to continue
   reading even if the chunk has been changed since.
+* With background commits, the save on disk stays at the previous commit()
+  until the writer thread is done; a crash in the meantime loses only the
+  commit in flight.
+* The summary is rewritten in place just before the commit it belongs to,
+  so a crash may leave it describing a commit that never happened.
 */
 
 #include "AppHdr.h"
@@ -32,12 +37,26 @@ Notes:
 #if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
 #include <unistd.h>
 #endif
+#ifdef UNIX
+#include <sys/mman.h>
+#define USE_MMAP
+#endif
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef USE_LZ4
+#include <lz4frame.h>
+#endif
 
 #include "end.h"
 #include "endianness.h"
 #include "errors.h"
 #include "syscalls.h"
 #include "libutil.h" // map_find
+#include "threads.h"
 
 // debugging defines
 #undef  FSCK_VERBOSE
@@ -59,14 +78,33 @@ static plen_t htole(plen_t x)
 #define dprintf(...) do {} while (0)
 #endif
 
+// Version 2 adds a codec to each directory entry. It is written only when
+// some chunk needs it, so saves that use just the base codec can still be
+// read by older builds.
 #define PACKAGE_VERSION 1
+#define PACKAGE_VERSION_CODECS 2
 #define PACKAGE_MAGIC   0x53534344 /* "DCSS" */
 
+// The codec of chunks that have none recorded in the directory, and of the
+// directory itself.
+#ifdef USE_ZLIB
+static const save_codec BASE_CODEC = save_codec::zlib;
+#else
+static const save_codec BASE_CODEC = save_codec::none;
+#endif
+
+// Room for the summary between the file header and the first block, in
+// packages that have the PACKAGE_HAS_SUMMARY flag. Older builds don't know
+// the flag, and clear it when they commit.
+#define PACKAGE_SUMMARY_SPACE 1012
+#define PACKAGE_HAS_SUMMARY 1
+
 struct file_header
 {
     uint32_t magic;
     uint8_t version;
-    char padding[3];
+    uint8_t flags;
+    char padding[2];
     plen_t start;
 };
 
@@ -82,10 +120,12 @@ typedef map<plen_t, bm_p> bm_t;
 typedef map<plen_t, plen_t> fb_t;
 
 package::package(const char* file, bool writeable, bool empty)
-  : n_users(0), dirty(false), aborted(false)
+  : image(nullptr), n_users(0), dirty(false), aborted(false)
 #ifdef DO_FSYNC
     , tmp(false)
 #endif
+    , codec(BASE_CODEC), background(false), has_summary(false),
+    summary_dirty(false), n_deferred(0)
 {
     dprintf("package: initializing file=\"%s\" rw=%d\n", file, writeable);
     ASSERT(writeable || !empty);
@@ -105,7 +145,8 @@ package::package(const char* file, bool writeable, bool empty)
         }
 
         dirty = true;
-        file_len = sizeof(file_header);
+        has_summary = true;
+        file_len = data_start();
     }
     else
     {
@@ -132,10 +173,12 @@ package::package(const char* file, bool writeable, bool empty)
 }
 
 package::package()
-  : rw(true), n_users(0), dirty(false), aborted(false)
+  : rw(true), image(nullptr), n_users(0), dirty(false), aborted(false)
 #ifdef DO_FSYNC
     , tmp(true)
 #endif
+    , codec(BASE_CODEC), background(false), has_summary(false),
+    summary_dirty(false), n_deferred(0)
 {
     dprintf("package: initializing tmp file\n");
     filename = "[tmp]";
@@ -163,8 +206,8 @@ void package::load()
     ssize_t res = ::read(fd, &head, sizeof(file_header));
     if (res < 0)
         sysfail("error reading the save file (%s)", filename.c_str());
-    if (!res || !(head.magic || head.version || head.padding[0]
-                  || head.padding[1] || head.padding[2] || head.start))
+    if (!res || !(head.magic || head.version || head.flags
+                  || head.padding[0] || head.padding[1] || head.start))
     {
         corrupted("The save file (%s) is empty!", filename.c_str());
     }
@@ -180,12 +223,40 @@ void package::load()
     if (len == -1)
         sysfail("save file (%s) is not seekable", filename.c_str());
     file_len = len;
+    has_summary = head.flags & PACKAGE_HAS_SUMMARY;
+    if (file_len < data_start())
+        corrupted("save file (%s) corrupted -- summary truncated",
+                  filename.c_str());
+    if (!rw)
+        map_image();
     read_directory(htole(head.start), head.version);
 
     if (rw)
         load_traces();
 }
 
+// Readers of a mapped package walk the block chains in memory rather than
+// seeking and reading; if mmap can't be had, they just fall back to that.
+// Writeable packages grow and rewrite the file, so they're never mapped.
+void package::map_image()
+{
+#ifdef USE_MMAP
+    ASSERT(!rw);
+    void *p = mmap(nullptr, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED)
+        image = static_cast<const unsigned char *>(p);
+#endif
+}
+
+void package::unmap_image()
+{
+#ifdef USE_MMAP
+    if (image)
+        munmap(const_cast<unsigned char *>(image), file_len);
+#endif
+    image = nullptr;
+}
+
 void package::load_traces()
 {
     ASSERT(!dirty);
@@ -193,7 +264,7 @@ void package::load_traces()
     if (directory.empty() || !block_map.empty())
         return;
 
-    free_blocks[sizeof(file_header)] = file_len - sizeof(file_header);
+    free_blocks[data_start()] = file_len - data_start();
 
     for (const auto &entry : directory)
         trace_chunk(entry.second);
@@ -208,19 +279,32 @@ void package::load_traces()
 package::~package()
 {
     dprintf("package: finalizing\n");
-    ASSERT(!n_users || CrawlIsCrashing); // not merely aborted, there are
-        // live pointers to us. With normal stack unwinding, destructors
-        // will make sure this never happens and this assert is good for
-        // catching missing manual deletes. The C++ exit handler is the
-        // only place that can be legitimately call things in wrong order.
-
-    if (rw && !aborted)
+    // The writer thread uses n_users too.
+    std::exception_ptr failed = join_commit();
+    ASSERT((!n_users && !n_deferred) || CrawlIsCrashing); // not merely
+        // aborted, there are live pointers to us. With normal stack
+        // unwinding, destructors will make sure this never happens and this
+        // assert is good for catching missing manual deletes. The C++ exit
+        // handler is the only place that can be legitimately call things in
+        // wrong order.
+
+    if (failed)
     {
-        commit();
+        // Whoever deleted us should have called sync() to hear about this,
+        // and a destructor can't throw. The file is still as it was at the
+        // last commit that made it, so leave it that way.
+        dprintf("package: background commit failed, not saving\n");
+    }
+    else if (rw && !aborted)
+    {
+        write_deferred(deferred);
+        commit_now();
         if (ftruncate(fd, file_len))
             sysfail("failed to update save file");
     }
 
+    unmap_image();
+
     // all errors here should be cached write errors
     if (fd != -1)
         if (close(fd) && !aborted)
@@ -231,7 +315,74 @@ package::~package()
     dprintf("package: closed\n");
 }
 
+// A commit() being carried out on a thread of its own.
+struct background_commit
+{
+    package *pkg;
+    vector<package::deferred_chunk> chunks;
+    thread_t thread;
+    std::exception_ptr error;
+};
+
+void *package::commit_thread(void *arg)
+{
+    background_commit *job = static_cast<background_commit *>(arg);
+    try
+    {
+        job->pkg->write_deferred(job->chunks);
+        job->pkg->commit_now();
+    }
+    catch (...)
+    {
+        job->error = std::current_exception();
+    }
+    return nullptr;
+}
+
 void package::commit()
+{
+    ASSERT(rw);
+    // Only one commit may be in flight at a time.
+    sync();
+    if (!background || (deferred.empty() && !dirty))
+    {
+        write_deferred(deferred);
+        commit_now();
+        return;
+    }
+    ASSERT(!aborted);
+
+    committing.reset(new background_commit);
+    committing->pkg = this;
+    committing->chunks.swap(deferred);
+    if (thread_create_joinable(&committing->thread, commit_thread,
+                               committing.get()))
+    {
+        // No thread to be had; just do it here.
+        deferred.swap(committing->chunks);
+        committing.reset();
+        write_deferred(deferred);
+        commit_now();
+    }
+}
+
+std::exception_ptr package::join_commit()
+{
+    if (!committing)
+        return nullptr;
+    thread_join(committing->thread);
+    std::exception_ptr error = committing->error;
+    committing.reset();
+    return error;
+}
+
+void package::sync()
+{
+    if (std::exception_ptr error = join_commit())
+        std::rethrow_exception(error);
+}
+
+void package::commit_now()
 {
     ASSERT(rw);
     if (!dirty)
@@ -244,9 +395,11 @@ void package::commit()
 
     file_header head;
     head.magic = htole(PACKAGE_MAGIC);
-    head.version = PACKAGE_VERSION;
+    head.flags = has_summary ? PACKAGE_HAS_SUMMARY : 0;
     memset(&head.padding, 0, sizeof(head.padding));
-    head.start = htole(write_directory());
+    head.start = htole(write_directory(head.version));
+    if (summary_dirty)
+        write_summary();
 #ifdef DO_FSYNC
     // We need a barrier before updating the link to point at the new directory.
     if (!tmp && fdatasync(fd))
@@ -269,6 +422,78 @@ void package::commit()
 #endif
 }
 
+plen_t package::data_start() const
+{
+    return sizeof(file_header) + (has_summary ? PACKAGE_SUMMARY_SPACE : 0);
+}
+
+void package::set_summary(const vector<unsigned char> &data)
+{
+    // The writer thread may be busy with the old one.
+    sync();
+    if (!has_summary || data == summary)
+        return;
+    summary = data;
+    summary_dirty = true;
+    dirty = true;
+}
+
+void package::write_summary()
+{
+    ASSERT(has_summary);
+    // One that doesn't fit is left out; readers have the chunks to go by.
+    const plen_t len = sizeof(plen_t) + summary.size() <= PACKAGE_SUMMARY_SPACE
+                       ? summary.size() : 0;
+    vector<unsigned char> area(sizeof(plen_t) + len);
+    const plen_t len_le = htole(len);
+    memcpy(&area[0], &len_le, sizeof(plen_t));
+    if (len)
+        memcpy(&area[sizeof(plen_t)], summary.data(), len);
+
+    seek(sizeof(file_header));
+    if (write(fd, area.data(), area.size()) != (ssize_t)area.size())
+        sysfail("write error while saving");
+    summary_dirty = false;
+}
+
+// Only the file header and the summary are read, with a single read().
+bool package::read_summary(const char *file, vector<unsigned char> &data)
+{
+    int fd = open_u(file, O_RDONLY | O_BINARY, 0666);
+    if (fd == -1)
+        sysfail("can't open save file (%s)", file);
+    if (!lock_file(fd, false))
+    {
+        close(fd);
+        game_ended(game_exit::abort,
+            "Another game is already in progress using this save!");
+    }
+
+    unsigned char buf[sizeof(file_header) + PACKAGE_SUMMARY_SPACE];
+    const ssize_t res = ::read(fd, buf, sizeof(buf));
+    close(fd);
+    // Anything wrong with the file is left for a full load to report.
+    if (res < (ssize_t)(sizeof(file_header) + sizeof(plen_t)))
+        return false;
+
+    file_header head;
+    memcpy(&head, buf, sizeof(file_header));
+    if (htole(head.magic) != PACKAGE_MAGIC
+        || !(head.flags & PACKAGE_HAS_SUMMARY))
+    {
+        return false;
+    }
+
+    plen_t len;
+    memcpy(&len, buf + sizeof(file_header), sizeof(plen_t));
+    len = htole(len);
+    const size_t at = sizeof(file_header) + sizeof(plen_t);
+    if (!len || len > (size_t)res - at)
+        return false;
+    data.assign(buf + at, buf + at + len);
+    return true;
+}
+
 void package::seek(plen_t to)
 {
     ASSERT(!aborted);
@@ -286,11 +511,37 @@ chunk_writer* package::writer(const string &name)
 
 chunk_reader* package::reader(const string &name)
 {
+    if (find_deferred(name))
+        return new chunk_reader(this, name);
+    sync();
     if (plen_t *ch = map_find(directory, name))
-        return new chunk_reader(this, *ch);
+        return new chunk_reader(this, *ch, chunk_codec(name));
     return 0;
 }
 
+bool package::set_codec(save_codec c)
+{
+    if (!save_codec_available(c))
+        return false;
+    codec = c;
+    return true;
+}
+
+void package::set_background(bool on)
+{
+    // Chunks written from now on go straight to the file.
+    if (!on)
+        sync();
+    background = on;
+}
+
+save_codec package::chunk_codec(const string &name) const
+{
+    if (const save_codec *c = map_find(codecs, name))
+        return *c;
+    return BASE_CODEC;
+}
+
 plen_t package::extend_block(plen_t at, plen_t size, plen_t by)
 {
     // the header is not counted into the block's size, yet takes space
@@ -359,10 +610,57 @@ plen_t package::alloc_block(plen_t &size)
     return at;
 }
 
-void package::finish_chunk(const string &name, plen_t at)
+void package::defer_chunk(const string &name, save_codec c,
+                          vector<char> &data)
+{
+    // Only the last write of a chunk matters.
+    auto held = std::make_shared<const vector<char>>(std::move(data));
+    for (deferred_chunk &ch : deferred)
+        if (ch.name == name)
+        {
+            ch.codec = c;
+            ch.data = held;
+            return;
+        }
+    deferred.push_back({name, c, held});
+}
+
+const package::deferred_chunk *package::find_deferred(const string &name) const
+{
+    for (const deferred_chunk &ch : deferred)
+        if (ch.name == name)
+            return &ch;
+    return nullptr;
+}
+
+// Compress and write out chunks kept in memory, emptying the list.
+void package::write_deferred(vector<deferred_chunk> &chunks)
+{
+    for (deferred_chunk &ch : chunks)
+    {
+        chunk_writer w(this, ch.name, ch.codec, false);
+        if (!ch.data->empty())
+            w.write(ch.data->data(), ch.data->size());
+    }
+    chunks.clear();
+}
+
+// Make the file up to date as far as the given chunk is concerned.
+void package::settle(const string &name)
+{
+    sync();
+    if (find_deferred(name))
+        write_deferred(deferred);
+}
+
+void package::finish_chunk(const string &name, plen_t at, save_codec c)
 {
     free_chunk(name);
     directory[name] = at;
+    if (c == BASE_CODEC)
+        codecs.erase(name);
+    else
+        codecs[name] = c;
     new_chunks.insert(at);
     dirty = true;
 }
@@ -384,14 +682,25 @@ void package::free_chunk(const string &name)
 
 void package::delete_chunk(const string &name)
 {
+    for (auto ch = deferred.begin(); ch != deferred.end(); ++ch)
+        if (ch->name == name)
+        {
+            deferred.erase(ch);
+            break;
+        }
+    sync();
     free_chunk(name);
     directory.erase(name);
+    codecs.erase(name);
 }
 
-plen_t package::write_directory()
+plen_t package::write_directory(uint8_t &version)
 {
-    delete_chunk("");
+    // Not delete_chunk(), this runs on the writer thread.
+    free_chunk("");
+    directory.erase("");
 
+    version = codecs.empty() ? PACKAGE_VERSION : PACKAGE_VERSION_CODECS;
     stringstream dir;
     for (const auto &entry : directory)
     {
@@ -400,6 +709,11 @@ plen_t package::write_directory()
         dir.write(&entry.first[0], entry.first.length());
         plen_t start = htole(entry.second);
         dir.write((const char*)&start, sizeof(plen_t));
+        if (version >= PACKAGE_VERSION_CODECS)
+        {
+            const uint8_t c = static_cast<uint8_t>(chunk_codec(entry.first));
+            dir.write((const char*)&c, sizeof(c));
+        }
     }
 
     ASSERT(dir.str().size());
@@ -448,7 +762,7 @@ void package::free_block_chain(plen_t at)
 
 void package::free_block(plen_t at, plen_t size)
 {
-    ASSERT(at >= sizeof(file_header));
+    ASSERT(at >= data_start());
     ASSERT(at + size <= file_len);
 
     auto neigh = free_blocks.lower_bound(at);
@@ -505,7 +819,7 @@ void package::fsck()
     }
     // after freeing everything, the file should be empty
     ASSERT(free_blocks.empty());
-    ASSERT(file_len == sizeof(file_header));
+    ASSERT(file_len == data_start());
 
     free_blocks = save_free_blocks;
     file_len = save_file_len;
@@ -523,7 +837,7 @@ void package::read_directory(plen_t start, uint8_t version)
     directory[""] = start;
 
     dprintf("package: reading directory\n");
-    chunk_reader rd(this, start);
+    chunk_reader rd(this, start, BASE_CODEC);
 
     switch (version)
     {
@@ -540,6 +854,7 @@ void package::read_directory(plen_t start, uint8_t version)
         }
         break;
     case 1:
+    case PACKAGE_VERSION_CODECS:
         uint8_t name_len;
         plen_t bstart;
         while (plen_t res = rd.read(&name_len, sizeof(name_len)))
@@ -553,6 +868,16 @@ void package::read_directory(plen_t start, uint8_t version)
             if (rd.read(&bstart, sizeof(bstart)) != sizeof(bstart))
                 corrupted("save file corrupted -- truncated directory");
             directory[chname] = htole(bstart);
+            if (version >= PACKAGE_VERSION_CODECS)
+            {
+                uint8_t c;
+                if (rd.read(&c, sizeof(c)) != sizeof(c))
+                    corrupted("save file corrupted -- truncated directory");
+                if (c >= static_cast<uint8_t>(save_codec::NUM_SAVE_CODECS))
+                    corrupted("save file corrupted -- unknown codec %u", c);
+                if (static_cast<save_codec>(c) != BASE_CODEC)
+                    codecs[chname] = static_cast<save_codec>(c);
+            }
             dprintf("* %s\n", chname.c_str());
         }
         break;
@@ -564,16 +889,25 @@ void package::read_directory(plen_t start, uint8_t version)
 
 bool package::has_chunk(const string &name)
 {
-    return !name.empty() && directory.count(name);
+    if (name.empty())
+        return false;
+    if (find_deferred(name))
+        return true;
+    sync();
+    return directory.count(name);
 }
 
 vector<string> package::list_chunks()
 {
+    sync();
     vector<string> list;
-    list.reserve(directory.size());
+    list.reserve(directory.size() + deferred.size());
     for (const auto &entry : directory)
         if (!entry.first.empty())
             list.push_back(entry.first);
+    for (const deferred_chunk &ch : deferred)
+        if (!directory.count(ch.name))
+            list.push_back(ch.name);
 
     return list;
 }
@@ -618,7 +952,10 @@ void package::abort()
 {
     // Disable any further operations, allow a shutdown. All errors past
     // this point are ignored (assuming we already failed). All writes since
-    // the last commit() are lost.
+    // the last commit() are lost. A commit() already under way is left to
+    // finish, as it was asked for before whatever went wrong.
+    join_commit();
+    deferred.clear();
     aborted = true;
 }
 
@@ -633,6 +970,8 @@ void package::unlink()
 // the amount of free space not at the end of file
 plen_t package::get_slack()
 {
+    sync();
+    write_deferred(deferred);
     load_traces();
 
     plen_t slack = 0;
@@ -643,6 +982,7 @@ plen_t package::get_slack()
 
 plen_t package::get_chunk_fragmentation(const string &name)
 {
+    settle(name);
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t frags = 0;
@@ -659,6 +999,7 @@ plen_t package::get_chunk_fragmentation(const string &name)
 
 plen_t package::get_chunk_compressed_length(const string &name)
 {
+    settle(name);
     load_traces();
     ASSERT(directory.count(name)); // not has_chunk(), "" is valid
     plen_t len = 0;
@@ -673,8 +1014,503 @@ plen_t package::get_chunk_compressed_length(const string &name)
     return len;
 }
 
+// Compresses the data of one chunk, handing the result to the writer.
+class chunk_encoder
+{
+public:
+    virtual ~chunk_encoder() {}
+    virtual void write(const void *data, plen_t len) = 0;
+    // Flush out everything; not called if the package has been aborted.
+    virtual void finish() = 0;
+
+protected:
+    chunk_encoder(chunk_writer &w) : sink(w) {}
+    void emit(const void *data, plen_t len) { sink.raw_write(data, len); }
+
+private:
+    chunk_writer &sink;
+};
+
+// Decompresses the data of one chunk, as the reader asks for it.
+class chunk_decoder
+{
+public:
+    virtual ~chunk_decoder() {}
+    // Returns less than len only at the end of the chunk.
+    virtual plen_t read(void *data, plen_t len) = 0;
+
+protected:
+    chunk_decoder(chunk_reader &r) : source(r) {}
+    plen_t fill(void *data, plen_t len) { return source.raw_read(data, len); }
+    // The next stretch of compressed input: straight out of the mapped file
+    // if there is one, otherwise read into buf. 0 at the end of the chunk.
+    plen_t next_input(const void *&in, void *buf, plen_t size)
+    {
+        if (source.mapped())
+            return source.next_span(in);
+        in = buf;
+        return fill(buf, size);
+    }
+
+private:
+    chunk_reader &source;
+};
+
+class stored_encoder : public chunk_encoder
+{
+public:
+    stored_encoder(chunk_writer &w) : chunk_encoder(w) {}
+    void write(const void *data, plen_t len) override { emit(data, len); }
+    void finish() override {}
+};
+
+class stored_decoder : public chunk_decoder
+{
+public:
+    stored_decoder(chunk_reader &r) : chunk_decoder(r) {}
+    plen_t read(void *data, plen_t len) override { return fill(data, len); }
+};
+
+// A chunk that is still only kept in memory, waiting for commit().
+class held_decoder : public chunk_decoder
+{
+public:
+    held_decoder(chunk_reader &r, std::shared_ptr<const vector<char>> d)
+        : chunk_decoder(r), held(std::move(d)), at(0) {}
+    plen_t read(void *data, plen_t len) override
+    {
+        len = min<size_t>(len, held->size() - at);
+        if (len)
+            memcpy(data, held->data() + at, len);
+        at += len;
+        return len;
+    }
+
+private:
+    std::shared_ptr<const vector<char>> held;
+    size_t at;
+};
+
+#ifdef USE_ZLIB
+#define ZB_SIZE 32768
+
+class zlib_encoder : public chunk_encoder
+{
+public:
+    zlib_encoder(chunk_writer &w) : chunk_encoder(w), ended(false)
+    {
+        zs.data_type = Z_BINARY;
+        zs.zalloc    = 0;
+        zs.zfree     = 0;
+        zs.opaque    = Z_NULL;
+        if (deflateInit(&zs, Z_DEFAULT_COMPRESSION))
+            fail("save file compression failed during init: %s", zs.msg);
+        zs.next_out  = z_buffer;
+        zs.avail_out = ZB_SIZE;
+    }
+
+    ~zlib_encoder()
+    {
+        // only after an abort; ignore errors, they're not relevant anymore
+        if (!ended)
+            deflateEnd(&zs);
+    }
+
+    void write(const void *data, plen_t len) override
+    {
+        zs.next_in  = (Bytef*)data;
+        zs.avail_in = len;
+        while (zs.avail_in)
+        {
+            if (!zs.avail_out)
+            {
+                emit(z_buffer, zs.next_out - z_buffer);
+                zs.next_out  = z_buffer;
+                zs.avail_out = ZB_SIZE;
+            }
+            // we don't allow Z_BUF_ERROR, so it's fatal for us
+            if (deflate(&zs, Z_NO_FLUSH) != Z_OK)
+                fail("save file compression failed: %s", zs.msg);
+        }
+    }
+
+    void finish() override
+    {
+        zs.avail_in = 0;
+        int res;
+        do
+        {
+            res = deflate(&zs, Z_FINISH);
+            if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
+                fail("save file compression failed: %s", zs.msg);
+            emit(z_buffer, zs.next_out - z_buffer);
+            zs.next_out = z_buffer;
+            zs.avail_out = ZB_SIZE;
+        } while (res != Z_STREAM_END);
+        ended = true;
+        if (deflateEnd(&zs) != Z_OK)
+            fail("save file compression failed during clean-up: %s", zs.msg);
+    }
+
+private:
+    z_stream zs;
+    Bytef z_buffer[ZB_SIZE];
+    bool ended;
+};
+
+class zlib_decoder : public chunk_decoder
+{
+public:
+    zlib_decoder(chunk_reader &r) : chunk_decoder(r), eof(false)
+    {
+        zs.zalloc    = 0;
+        zs.zfree     = 0;
+        zs.opaque    = Z_NULL;
+        zs.next_in   = Z_NULL;
+        zs.avail_in  = 0;
+        if (inflateInit(&zs))
+            fail("save file decompression failed during init: %s", zs.msg);
+    }
+
+    ~zlib_decoder()
+    {
+        if (inflateEnd(&zs) != Z_OK)
+            fail("save file decompression failed during clean-up: %s", zs.msg);
+    }
+
+    plen_t read(void *data, plen_t len) override
+    {
+        if (eof)
+            return 0;
+
+        zs.next_out  = (Bytef*)data;
+        zs.avail_out = len;
+        while (zs.avail_out)
+        {
+            if (!zs.avail_in)
+            {
+                const void *in;
+                zs.avail_in = next_input(in, z_buffer, sizeof(z_buffer));
+                zs.next_in  = (Bytef*)in;
+                if (!zs.avail_in)
+                    corrupted("save file corrupted -- block truncated");
+            }
+            int res = inflate(&zs, Z_NO_FLUSH);
+            if (res == Z_STREAM_END)
+            {
+                eof = true;
+                return zs.next_out - (Bytef*)data;
+            }
+            if (res != Z_OK)
+                corrupted("save file decompression failed: %s", zs.msg);
+        }
+        return zs.next_out - (Bytef*)data;
+    }
+
+private:
+    bool eof;
+    z_stream zs;
+    Bytef z_buffer[ZB_SIZE];
+};
+#endif
+
+#ifdef USE_ZSTD
+// zstd's default level, which is both faster and denser than zlib's.
+#define ZSTD_SAVE_LEVEL 3
+
+class zstd_encoder : public chunk_encoder
+{
+public:
+    zstd_encoder(chunk_writer &w)
+        : chunk_encoder(w), cctx(ZSTD_createCCtx()), buf(ZSTD_CStreamOutSize())
+    {
+        if (!cctx)
+            fail("save file compression failed during init");
+        check(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel,
+                                     ZSTD_SAVE_LEVEL));
+    }
+
+    ~zstd_encoder() { ZSTD_freeCCtx(cctx); }
+
+    void write(const void *data, plen_t len) override
+    {
+        ZSTD_inBuffer in = { data, len, 0 };
+        while (in.pos < in.size)
+            compress(in, ZSTD_e_continue);
+    }
+
+    void finish() override
+    {
+        ZSTD_inBuffer in = { nullptr, 0, 0 };
+        while (compress(in, ZSTD_e_end))
+            ;
+    }
+
+private:
+    // Returns how much zstd has yet to flush.
+    size_t compress(ZSTD_inBuffer &in, ZSTD_EndDirective mode)
+    {
+        ZSTD_outBuffer out = { buf.data(), buf.size(), 0 };
+        const size_t left = check(ZSTD_compressStream2(cctx, &out, &in, mode));
+        if (out.pos)
+            emit(buf.data(), out.pos);
+        return left;
+    }
+
+    static size_t check(size_t res)
+    {
+        if (ZSTD_isError(res))
+            fail("save file compression failed: %s", ZSTD_getErrorName(res));
+        return res;
+    }
+
+    ZSTD_CCtx *cctx;
+    vector<char> buf;
+};
+
+class zstd_decoder : public chunk_decoder
+{
+public:
+    zstd_decoder(chunk_reader &r)
+        : chunk_decoder(r), dctx(ZSTD_createDCtx()), buf(ZSTD_DStreamInSize()),
+          eof(false)
+    {
+        if (!dctx)
+            fail("save file decompression failed during init");
+        in.src = buf.data();
+        in.size = in.pos = 0;
+    }
+
+    ~zstd_decoder() { ZSTD_freeDCtx(dctx); }
+
+    plen_t read(void *data, plen_t len) override
+    {
+        ZSTD_outBuffer out = { data, len, 0 };
+        while (out.pos < out.size && !eof)
+        {
+            if (in.pos == in.size)
+            {
+                in.size = next_input(in.src, buf.data(), buf.size());
+                in.pos = 0;
+            }
+            const size_t was = out.pos;
+            const size_t res = ZSTD_decompressStream(dctx, &out, &in);
+            if (ZSTD_isError(res))
+            {
+                corrupted("save file decompression failed: %s",
+                          ZSTD_getErrorName(res));
+            }
+            if (!res)
+                eof = true;
+            else if (!in.size && out.pos == was)
+                corrupted("save file corrupted -- block truncated");
+        }
+        return out.pos;
+    }
+
+private:
+    ZSTD_DCtx *dctx;
+    vector<char> buf;
+    ZSTD_inBuffer in;
+    bool eof;
+};
+#endif
+
+#ifdef USE_LZ4
+// How much is handed to LZ4 at once; bounds the output buffer.
+#define LZ4_SAVE_BLOCK 65536
+
+class lz4_encoder : public chunk_encoder
+{
+public:
+    lz4_encoder(chunk_writer &w) : chunk_encoder(w)
+    {
+        memset(&prefs, 0, sizeof(prefs));
+        check(LZ4F_createCompressionContext(&cctx, LZ4F_VERSION));
+        buf.resize(LZ4F_compressBound(LZ4_SAVE_BLOCK, &prefs));
+        emit(buf.data(), check(LZ4F_compressBegin(cctx, buf.data(),
+                                                  buf.size(), &prefs)));
+    }
+
+    ~lz4_encoder() { LZ4F_freeCompressionContext(cctx); }
+
+    void write(const void *data, plen_t len) override
+    {
+        const char *src = static_cast<const char *>(data);
+        while (len)
+        {
+            const plen_t s = min<plen_t>(len, LZ4_SAVE_BLOCK);
+            const size_t n = check(LZ4F_compressUpdate(cctx, buf.data(),
+                                                       buf.size(), src, s,
+                                                       nullptr));
+            if (n)
+                emit(buf.data(), n);
+            src += s;
+            len -= s;
+        }
+    }
+
+    void finish() override
+    {
+        emit(buf.data(), check(LZ4F_compressEnd(cctx, buf.data(), buf.size(),
+                                                nullptr)));
+    }
+
+private:
+    static size_t check(size_t res)
+    {
+        if (LZ4F_isError(res))
+            fail("save file compression failed: %s", LZ4F_getErrorName(res));
+        return res;
+    }
+
+    LZ4F_cctx *cctx;
+    LZ4F_preferences_t prefs;
+    vector<char> buf;
+};
+
+class lz4_decoder : public chunk_decoder
+{
+public:
+    lz4_decoder(chunk_reader &r)
+        : chunk_decoder(r), buf(32768), in(nullptr), in_pos(0), in_len(0),
+          eof(false)
+    {
+        const size_t res = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+        if (LZ4F_isError(res))
+        {
+            fail("save file decompression failed during init: %s",
+                 LZ4F_getErrorName(res));
+        }
+    }
+
+    ~lz4_decoder() { LZ4F_freeDecompressionContext(dctx); }
+
+    plen_t read(void *data, plen_t len) override
+    {
+        char *out = static_cast<char *>(data);
+        plen_t done = 0;
+        while (done < len && !eof)
+        {
+            if (in_pos == in_len)
+            {
+                const void *src;
+                in_len = next_input(src, buf.data(), buf.size());
+                in = static_cast<const char *>(src);
+                in_pos = 0;
+            }
+            size_t dst = len - done;
+            size_t src = in_len - in_pos;
+            const size_t res = LZ4F_decompress(dctx, out + done, &dst,
+                                               in + in_pos, &src,
+                                               nullptr);
+            if (LZ4F_isError(res))
+            {
+                corrupted("save file decompression failed: %s",
+                          LZ4F_getErrorName(res));
+            }
+            done += dst;
+            in_pos += src;
+            if (!res)
+                eof = true;
+            else if (!in_len && !dst)
+                corrupted("save file corrupted -- block truncated");
+        }
+        return done;
+    }
+
+private:
+    LZ4F_dctx *dctx;
+    vector<char> buf;
+    const char *in;
+    size_t in_pos, in_len;
+    bool eof;
+};
+#endif
+
+bool save_codec_available(save_codec codec)
+{
+    switch (codec)
+    {
+    case save_codec::none:
+#ifdef USE_ZLIB
+    case save_codec::zlib:
+#endif
+#ifdef USE_ZSTD
+    case save_codec::zstd:
+#endif
+#ifdef USE_LZ4
+    case save_codec::lz4:
+#endif
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char *save_codec_name(save_codec codec)
+{
+    switch (codec)
+    {
+    case save_codec::zlib: return "zlib";
+    case save_codec::none: return "none";
+    case save_codec::zstd: return "zstd";
+    case save_codec::lz4:  return "lz4";
+    default:               return "unknown";
+    }
+}
+
+static chunk_encoder *_make_encoder(save_codec codec, chunk_writer &w)
+{
+    switch (codec)
+    {
+    case save_codec::none: return new stored_encoder(w);
+#ifdef USE_ZLIB
+    case save_codec::zlib: return new zlib_encoder(w);
+#endif
+#ifdef USE_ZSTD
+    case save_codec::zstd: return new zstd_encoder(w);
+#endif
+#ifdef USE_LZ4
+    case save_codec::lz4:  return new lz4_encoder(w);
+#endif
+    default:
+        die("save codec %s is not supported", save_codec_name(codec));
+    }
+}
+
+static chunk_decoder *_make_decoder(save_codec codec, chunk_reader &r)
+{
+    switch (codec)
+    {
+    case save_codec::none: return new stored_decoder(r);
+#ifdef USE_ZLIB
+    case save_codec::zlib: return new zlib_decoder(r);
+#endif
+#ifdef USE_ZSTD
+    case save_codec::zstd: return new zstd_decoder(r);
+#endif
+#ifdef USE_LZ4
+    case save_codec::lz4:  return new lz4_decoder(r);
+#endif
+    default:
+        corrupted("save file uses %s compression, which this build doesn't "
+                  "support", save_codec_name(codec));
+    }
+}
+
+// The file header has no room for the directory's codec, and the directory
+// is only ever written by commit() itself.
 chunk_writer::chunk_writer(package *parent, const string &_name)
-    : first_block(0), cur_block(0), block_len(0)
+    : chunk_writer(parent, _name,
+                   _name.empty() ? BASE_CODEC : parent->codec,
+                   parent->background && !_name.empty())
+{
+}
+
+chunk_writer::chunk_writer(package *parent, const string &_name,
+                           save_codec _codec, bool defer)
+    : first_block(0), cur_block(0), block_len(0), deferred(defer)
 {
     ASSERT(parent);
     ASSERT(!parent->aborted);
@@ -685,57 +1521,41 @@ chunk_writer::chunk_writer(package *parent, const string &_name)
 
     dprintf("chunk_writer(%s): starting\n", _name.c_str());
     pkg = parent;
-    pkg->n_users++;
     name = _name;
-
-#ifdef USE_ZLIB
-    zs.data_type = Z_BINARY;
-    zs.zalloc    = 0;
-    zs.zfree     = 0;
-    zs.opaque    = Z_NULL;
-    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION))
-        fail("save file compression failed during init: %s", zs.msg);
-#define ZB_SIZE 32768
-    zs.next_out  = z_buffer = (Bytef*)malloc(ZB_SIZE);
-    zs.avail_out = ZB_SIZE;
-#endif
+    codec = _codec;
+    // A writer thread may be busy with the file and n_users meanwhile.
+    if (deferred)
+    {
+        pkg->n_deferred++;
+        return;
+    }
+    pkg->n_users++;
+    enc.reset(_make_encoder(codec, *this));
 }
 
 chunk_writer::~chunk_writer()
 {
     dprintf("chunk_writer(%s): closing\n", name.c_str());
 
+    if (deferred)
+    {
+        ASSERT(pkg->n_deferred > 0);
+        pkg->n_deferred--;
+        if (!pkg->aborted)
+            pkg->defer_chunk(name, codec, buffered);
+        return;
+    }
+
     ASSERT(pkg->n_users > 0);
     pkg->n_users--;
     if (pkg->aborted)
-    {
-#ifdef USE_ZLIB
-        // ignore errors, they're not relevant anymore
-        deflateEnd(&zs);
-        free(z_buffer);
-#endif
         return;
-    }
 
-#ifdef USE_ZLIB
-    zs.avail_in = 0;
-    int res;
-    do
-    {
-        res = deflate(&zs, Z_FINISH);
-        if (res != Z_STREAM_END && res != Z_OK && res != Z_BUF_ERROR)
-            fail("save file compression failed: %s", zs.msg);
-        raw_write(z_buffer, zs.next_out - z_buffer);
-        zs.next_out = z_buffer;
-        zs.avail_out = ZB_SIZE;
-    } while (res != Z_STREAM_END);
-    if (deflateEnd(&zs) != Z_OK)
-        fail("save file compression failed during clean-up: %s", zs.msg);
-    free(z_buffer);
-#endif
+    enc->finish();
+    enc.reset();
     if (cur_block)
         finish_block(0);
-    pkg->finish_chunk(name, first_block);
+    pkg->finish_chunk(name, first_block, codec);
 }
 
 void chunk_writer::raw_write(const void *data, plen_t len)
@@ -782,75 +1602,76 @@ void chunk_writer::write(const void *data, plen_t len)
     ASSERT(data);
     ASSERT(!pkg->aborted);
 
-#ifdef USE_ZLIB
-    zs.next_in  = (Bytef*)data;
-    zs.avail_in = len;
-    while (zs.avail_in)
-    {
-        if (!zs.avail_out)
-        {
-            raw_write(z_buffer, zs.next_out - z_buffer);
-            zs.next_out  = z_buffer;
-            zs.avail_out = ZB_SIZE;
-        }
-        // we don't allow Z_BUF_ERROR, so it's fatal for us
-        if (deflate(&zs, Z_NO_FLUSH) != Z_OK)
-            fail("save file compression failed: %s", zs.msg);
-    }
-#else
-    raw_write(data, len);
-#endif
+    if (deferred)
+        buffered.insert(buffered.end(), (const char*)data,
+                        (const char*)data + len);
+    else
+        enc->write(data, len);
 }
 
-void chunk_reader::init(plen_t start)
+void chunk_reader::init(plen_t start, save_codec codec)
 {
     ASSERT(!pkg->aborted);
+    if (!start && codec != save_codec::none)
+    {
+        corrupted("save file corrupted -- %s header missing",
+                  save_codec_name(codec));
+    }
+    dec.reset(_make_decoder(codec, *this));
+
     pkg->n_users++;
     pkg->reader_count[start]++;
     first_block = next_block = start;
     block_left = 0;
-
-#ifdef USE_ZLIB
-    if (!start)
-        corrupted("save file corrupted -- zlib header missing");
-
-    zs.zalloc    = 0;
-    zs.zfree     = 0;
-    zs.opaque    = Z_NULL;
-    zs.next_in   = Z_NULL;
-    zs.avail_in  = 0;
-    if (inflateInit(&zs))
-        fail("save file decompression failed during init: %s", zs.msg);
-    eof = false;
-#endif
 }
 
-chunk_reader::chunk_reader(package *parent, plen_t start)
+chunk_reader::chunk_reader(package *parent, plen_t start, save_codec codec)
+    : in_memory(false)
 {
     ASSERT(parent);
     dprintf("chunk_reader[%u]: starting\n", start);
     pkg = parent;
-    init(start);
+    init(start, codec);
 }
 
 chunk_reader::chunk_reader(package *parent, const string &_name)
+    : in_memory(false)
 {
     ASSERT(parent);
+    // A chunk not yet committed is read as it was written, without waiting
+    // for a background commit or compressing anything. Like deferred
+    // writers, this must stay off n_users while a writer thread runs.
+    if (const package::deferred_chunk *ch = parent->find_deferred(_name))
+    {
+        ASSERT(!parent->aborted);
+        dprintf("chunk_reader(%s): starting in memory\n", _name.c_str());
+        pkg = parent;
+        in_memory = true;
+        first_block = next_block = 0;
+        block_left = 0;
+        dec.reset(new held_decoder(*this, ch->data));
+        pkg->n_deferred++;
+        return;
+    }
+    parent->sync();
     if (!parent->has_chunk(_name))
         corrupted("save file corrupted -- chunk \"%s\" missing", _name.c_str());
     dprintf("chunk_reader(%s): starting\n", _name.c_str());
     pkg = parent;
-    init(parent->directory[_name]);
+    init(parent->directory[_name], parent->chunk_codec(_name));
 }
 
 chunk_reader::~chunk_reader()
 {
     dprintf("chunk_reader: closing\n");
 
-#ifdef USE_ZLIB
-    if (inflateEnd(&zs) != Z_OK)
-        fail("save file decompression failed during clean-up: %s", zs.msg);
-#endif
+    dec.reset();
+    if (in_memory)
+    {
+        ASSERT(pkg->n_deferred > 0);
+        pkg->n_deferred--;
+        return;
+    }
     ASSERT(pkg->reader_count[first_block] > 0);
     if (!--pkg->reader_count[first_block])
         pkg->reader_count.erase(first_block);
@@ -858,6 +1679,45 @@ chunk_reader::~chunk_reader()
     pkg->n_users--;
 }
 
+bool chunk_reader::mapped() const
+{
+    return pkg->image;
+}
+
+// Move on to the next block of the chain, if any.
+bool chunk_reader::start_block()
+{
+    if (!next_block)
+        return false;
+
+    block_header bl;
+    if (pkg->image)
+    {
+        if (next_block > pkg->file_len - sizeof(block_header))
+            corrupted("save file corrupted -- block past eof");
+        memcpy(&bl, pkg->image + next_block, sizeof(block_header));
+    }
+    else
+    {
+        pkg->seek(next_block);
+        ssize_t res = ::read(pkg->fd, &bl, sizeof(block_header));
+        if (res < 0)
+            sysfail("error reading the save file");
+        if (res != sizeof(block_header))
+            corrupted("save file corrupted -- block past eof");
+    }
+
+    off = next_block + sizeof(block_header);
+    block_left = htole(bl.len);
+    next_block = htole(bl.next);
+    // This reeks of on-disk corruption (zeroed data).
+    if (!block_left)
+        corrupted("save file corrupted -- empty block");
+    if (pkg->image && block_left > pkg->file_len - off)
+        corrupted("save file corrupted -- block past eof");
+    return true;
+}
+
 plen_t chunk_reader::raw_read(void *data, plen_t len)
 {
     void *buf = data;
@@ -865,35 +1725,25 @@ plen_t chunk_reader::raw_read(void *data, plen_t len)
     {
         if (!block_left)
         {
-            if (!next_block)
+            if (!start_block())
                 return (char*)buf - (char*)data;
-
-            block_header bl;
-            pkg->seek(next_block);
-            ssize_t res = ::read(pkg->fd, &bl, sizeof(block_header));
-            if (res < 0)
-                sysfail("error reading the save file");
-            if (res != sizeof(block_header))
-                corrupted("save file corrupted -- block past eof");
-
-            off = next_block + sizeof(block_header);
-            block_left = htole(bl.len);
-            next_block = htole(bl.next);
-            // This reeks of on-disk corruption (zeroed data).
-            if (!block_left)
-                corrupted("save file corrupted -- empty block");
         }
-        else
+        else if (!pkg->image)
             pkg->seek(off);
 
         plen_t s = len;
         if (s > block_left)
             s = block_left;
-        ssize_t res = ::read(pkg->fd, buf, s);
-        if (res < 0)
-            sysfail("error reading the save file");
-        if ((plen_t)res != s)
-            corrupted("save file corrupted -- block past eof");
+        if (pkg->image)
+            memcpy(buf, pkg->image + off, s);
+        else
+        {
+            ssize_t res = ::read(pkg->fd, buf, s);
+            if (res < 0)
+                sysfail("error reading the save file");
+            if ((plen_t)res != s)
+                corrupted("save file corrupted -- block past eof");
+        }
 
         buf = (char*)buf + s;
         off += s;
@@ -904,42 +1754,30 @@ plen_t chunk_reader::raw_read(void *data, plen_t len)
     return (char*)buf - (char*)data;
 }
 
+// Point data at the rest of the current block in the mapped file, or the
+// next one; returns 0 at the end of the chunk.
+plen_t chunk_reader::next_span(const void *&data)
+{
+    ASSERT(pkg->image);
+    if (!block_left && !start_block())
+        return 0;
+
+    data = pkg->image + off;
+    const plen_t len = block_left;
+    off += len;
+    block_left = 0;
+    return len;
+}
+
 plen_t chunk_reader::read(void *data, plen_t len)
 {
     ASSERT(data);
     if (pkg->aborted)
         return 0;
-
-#ifdef USE_ZLIB
     if (!len)
         return 0;
-    if (eof)
-        return 0;
 
-    zs.next_out  = (Bytef*)data;
-    zs.avail_out = len;
-    while (zs.avail_out)
-    {
-        if (!zs.avail_in)
-        {
-            zs.next_in  = z_buffer;
-            zs.avail_in = raw_read(z_buffer, sizeof(z_buffer));
-            if (!zs.avail_in)
-                corrupted("save file corrupted -- block truncated");
-        }
-        int res = inflate(&zs, Z_NO_FLUSH);
-        if (res == Z_STREAM_END)
-        {
-            eof = true;
-            return zs.next_out - (Bytef*)data;
-        }
-        if (res != Z_OK)
-            corrupted("save file decompression failed: %s", zs.msg);
-    }
-    return zs.next_out - (Bytef*)data;
-#else
-    return raw_read(data, len);
-#endif
+    return dec->read(data, len);
 }
 
 void chunk_reader::read_all(vector<char> &data)
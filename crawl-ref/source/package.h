@@ -2,13 +2,14 @@
 
 #define USE_ZLIB
 
+#include <exception>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
-#ifdef USE_ZLIB
-#include <zlib.h>
-#endif
+
+#include "save-codec-type.h"
 
 using std::map;
 using std::pair;
@@ -25,19 +26,28 @@ using std::vector;
 typedef uint32_t plen_t;
 
 class package;
+class chunk_encoder;
+class chunk_decoder;
+struct background_commit;
+
+bool save_codec_available(save_codec codec);
+const char *save_codec_name(save_codec codec);
 
 class chunk_writer
 {
 private:
     package *pkg;
     string name;
+    save_codec codec;
     plen_t first_block;
     plen_t cur_block;
     plen_t block_len;
-#ifdef USE_ZLIB
-    z_stream zs;
-    Bytef *z_buffer;
-#endif
+    std::unique_ptr<chunk_encoder> enc;
+    // Set if the data is only kept in memory until the next commit().
+    bool deferred;
+    vector<char> buffered;
+    chunk_writer(package *parent, const string &_name, save_codec _codec,
+                 bool defer);
     void raw_write(const void *data, plen_t len);
     void finish_block(plen_t next);
 public:
@@ -45,28 +55,31 @@ public:
     ~chunk_writer();
     void write(const void *data, plen_t len);
     friend class package;
+    friend class chunk_encoder;
 };
 
 class chunk_reader
 {
 private:
-    chunk_reader(package *parent, plen_t start);
-    void init(plen_t start);
+    chunk_reader(package *parent, plen_t start, save_codec codec);
+    void init(plen_t start, save_codec codec);
     package *pkg;
     plen_t first_block, next_block;
     plen_t off, block_left;
-#ifdef USE_ZLIB
-    bool eof;
-    z_stream zs;
-    Bytef z_buffer[32768];
-#endif
+    std::unique_ptr<chunk_decoder> dec;
+    // Set if reading a chunk that is still only kept in memory.
+    bool in_memory;
+    bool start_block();
     plen_t raw_read(void *data, plen_t len);
+    plen_t next_span(const void *&data);
+    bool mapped() const;
 public:
     chunk_reader(package *parent, const string &_name);
     ~chunk_reader();
     plen_t read(void *data, plen_t len);
     void read_all(vector<char> &data);
     friend class package;
+    friend class chunk_decoder;
 };
 
 class package
@@ -77,7 +90,27 @@ public:
     ~package();
     chunk_writer* writer(const string &name);
     chunk_reader* reader(const string &name);
+    // Compress chunks written from now on with this codec. Returns false,
+    // leaving the codec unchanged, if this build doesn't support it.
+    bool set_codec(save_codec c);
+    save_codec get_codec() const { return codec; }
+    save_codec chunk_codec(const string &name) const;
+    // With background commits on, chunks are only kept in memory until
+    // commit(), which then compresses and writes them out on a thread of
+    // its own and returns at once. Reading such a chunk back before then
+    // is served from memory; anything else that needs the file waits for
+    // the background commit to finish first, and rethrows its error.
+    void set_background(bool on);
     void commit();
+    // Wait for a background commit, if any, to land, rethrowing its error.
+    // Call this before deleting a package that may have one under way:
+    // the destructor can't report it.
+    void sync();
+    // A small record kept uncompressed right after the file header and
+    // updated by the next commit(), so that it can be read back without
+    // loading the package. Only packages created empty have room for it.
+    void set_summary(const vector<unsigned char> &data);
+    static bool read_summary(const char *file, vector<unsigned char> &data);
     void delete_chunk(const string &name);
     bool has_chunk(const string &name);
     vector<string> list_chunks();
@@ -95,6 +128,8 @@ private:
     bool rw;
     int fd;
     plen_t file_len;
+    // The whole file, when a read-only package could map it into memory.
+    const unsigned char *image;
     int n_users;
     bool dirty;
     bool aborted;
@@ -102,6 +137,25 @@ private:
     bool tmp;
 #endif
     map<string, plen_t> directory;
+    // Chunks not compressed with the default codec; see chunk_codec().
+    map<string, save_codec> codecs;
+    save_codec codec;
+    bool background;
+    bool has_summary;
+    bool summary_dirty;
+    vector<unsigned char> summary;
+    // Chunks written since the last commit(), not yet in the file.
+    struct deferred_chunk
+    {
+        string name;
+        save_codec codec;
+        // Shared with readers, so they can go on reading it after the
+        // chunk is rewritten or committed.
+        std::shared_ptr<const vector<char>> data;
+    };
+    vector<deferred_chunk> deferred;
+    int n_deferred;
+    std::unique_ptr<background_commit> committing;
     map<plen_t, plen_t> free_blocks;
     vector<plen_t> unlinked_blocks;
     map<plen_t, pair<plen_t, plen_t> > block_map;
@@ -109,9 +163,18 @@ private:
     map<plen_t, uint32_t> reader_count;
     plen_t extend_block(plen_t at, plen_t size, plen_t by);
     plen_t alloc_block(plen_t &size);
-    void finish_chunk(const string &name, plen_t at);
+    void finish_chunk(const string &name, plen_t at, save_codec c);
+    void defer_chunk(const string &name, save_codec c, vector<char> &data);
+    const deferred_chunk *find_deferred(const string &name) const;
+    void write_deferred(vector<deferred_chunk> &chunks);
+    void settle(const string &name);
+    void commit_now();
+    std::exception_ptr join_commit();
+    static void *commit_thread(void *arg);
     void free_chunk(const string &name);
-    plen_t write_directory();
+    plen_t write_directory(uint8_t &version);
+    void write_summary();
+    plen_t data_start() const;
     void collect_blocks();
     void free_block_chain(plen_t at);
     void free_block(plen_t at, plen_t size);
@@ -121,6 +184,9 @@ private:
     void trace_chunk(plen_t start);
     void load();
     void load_traces();
+    void map_image();
+    void unmap_image();
     friend class chunk_writer;
     friend class chunk_reader;
+    friend struct background_commit;
 };
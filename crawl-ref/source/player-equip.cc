@@ -74,6 +74,7 @@ void equip_item(equipment_type slot, int item_slot, bool msg, bool skip_effects)
 #endif
 
     you.equip[slot] = item_slot;
+    you.invalidate_artefact_totals();
 
     if (!skip_effects)
         equip_effect(slot, item_slot, false, msg);
@@ -106,6 +107,7 @@ bool unequip_item(equipment_type slot, bool msg, bool skip_effects)
 #endif
 
         you.equip[slot] = -1;
+        you.invalidate_artefact_totals();
 
         if (you.melded[slot])
         {
@@ -149,6 +151,7 @@ bool meld_slot(equipment_type slot)
     if (you.equip[slot] != -1 && !you.melded[slot])
     {
         you.melded.set(slot);
+        you.invalidate_artefact_totals();
         you.gear_change = true;
         return true;
     }
@@ -165,6 +168,7 @@ bool unmeld_slot(equipment_type slot)
     if (you.equip[slot] != -1 && you.melded[slot])
     {
         you.melded.set(slot, false);
+        you.invalidate_artefact_totals();
         you.gear_change = true;
         return true;
     }
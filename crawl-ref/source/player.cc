@@ -3528,22 +3528,22 @@ int slaying_bonus(bool throwing, bool random)
 }
 
 // Checks each equip slot for a randart, and adds up all of those with
-// a given property. Slow if any randarts are worn, so avoid where
-// possible. If `matches' is non-nullptr, items with nonzero property are
-// pushed onto *matches.
-int player::scan_artefacts(artefact_prop_type which_property,
-                           vector<const item_def *> *matches) const
+// a given property. If `matches' is non-nullptr, items with nonzero
+// property are pushed onto *matches.
+static int _scan_worn_artefacts(const player &p,
+                                artefact_prop_type which_property,
+                                vector<const item_def *> *matches)
 {
     int retval = 0;
 
     for (int i = EQ_FIRST_EQUIP; i < NUM_EQUIP; ++i)
     {
-        if (melded[i] || equip[i] == -1)
+        if (p.melded[i] || p.equip[i] == -1)
             continue;
 
-        const int eq = equip[i];
+        const int eq = p.equip[i];
 
-        const item_def &item = inv[eq];
+        const item_def &item = p.inv[eq];
 
         // Only weapons give their effects when in our hands.
         if (i == EQ_WEAPON
@@ -3564,17 +3564,47 @@ int player::scan_artefacts(artefact_prop_type which_property,
             matches->push_back(&item);
     }
 
-    if (you.active_talisman.defined() && is_artefact(you.active_talisman))
+    if (p.active_talisman.defined() && is_artefact(p.active_talisman))
     {
-        const int val = artefact_property(you.active_talisman, which_property);
+        const int val = artefact_property(p.active_talisman, which_property);
         retval += val;
         if (matches && val)
-            matches->push_back(&you.active_talisman);
+            matches->push_back(&p.active_talisman);
     }
 
     return retval;
 }
 
+// As _scan_worn_artefacts(), but without matches the totals for every
+// property are kept until invalidate_artefact_totals() is called, since
+// combat and AI code ask for them constantly.
+int player::scan_artefacts(artefact_prop_type which_property,
+                           vector<const item_def *> *matches) const
+{
+    if (matches)
+        return _scan_worn_artefacts(*this, which_property, matches);
+
+    if (!artp_totals_valid)
+    {
+        for (int i = 0; i < ART_PROPERTIES; ++i)
+        {
+            artp_totals[i] = _scan_worn_artefacts(*this,
+                                 static_cast<artefact_prop_type>(i), nullptr);
+        }
+        artp_totals_valid = true;
+    }
+
+#ifdef DEBUG
+    // Catch any change to worn gear that didn't invalidate the totals.
+    const int fresh = _scan_worn_artefacts(*this, which_property, nullptr);
+    ASSERTM(artp_totals[which_property] == fresh,
+            "stale artefact total for %s: %d, should be %d",
+            artp_name(which_property), artp_totals[which_property], fresh);
+#endif
+
+    return artp_totals[which_property];
+}
+
 bool player::using_talisman(const item_def &talisman) const
 {
     if (!active_talisman.defined())
@@ -5129,6 +5159,7 @@ player::player()
 
     equip.init(-1);
     melded.reset();
+    artp_totals_valid = false;
     unrand_reacts.reset();
     activated.reset();
     last_unequip = -1;
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "actor.h"
+#include "artefact-prop-type.h"
 #include "attribute-type.h"
 #include "beam.h"
 #include "bitary.h"
@@ -475,6 +476,10 @@ protected:
     FixedVector<PlaceInfo, NUM_BRANCHES> branch_info;
     map<level_id, LevelXPInfo> level_xp_info;
 
+    // scan_artefacts() totals for every property, over all worn items.
+    mutable FixedVector<int, ARTP_NUM_PROPERTIES> artp_totals;
+    mutable bool artp_totals_valid;
+
 public:
     player();
     virtual ~player();
@@ -663,6 +668,9 @@ public:
         override;
     int scan_artefacts(artefact_prop_type which_property,
                        vector<const item_def *> *matches = nullptr) const override;
+    // Must be called whenever what scan_artefacts() would see changes:
+    // equip/meld state, the active talisman, or a worn item's properties.
+    void invalidate_artefact_totals() { artp_totals_valid = false; }
 
     int infusion_amount() const;
 
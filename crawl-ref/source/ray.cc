@@ -22,6 +22,11 @@
 static geom::grid diamonds(geom::lineseq(1, 1, 0.5, 1),
                            geom::lineseq(1, -1, -0.5, 1));
 
+bool double_is_zero(const double x)
+{
+    return x > -EPSILON_VALUE && x < EPSILON_VALUE;
+}
+
 static int _ifloor(double d)
 {
     return static_cast<int>(floor(d));
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+// How the data of a chunk in a save package is compressed. The value is
+// stored in the package's directory, so only ever add to the end.
+enum class save_codec : uint8_t
+{
+    zlib,
+    none,
+    zstd,
+    lz4,
+    NUM_SAVE_CODECS
+};
@@ -13,6 +13,7 @@
 #include "areas.h"
 #include "artefact.h"
 #include "branch.h"
+#include "coordit.h"
 #include "database.h"
 #include "directn.h"
 #include "english.h"
@@ -36,7 +37,9 @@
 #include "view.h"
 #include "viewchar.h"
 
-static noise_grid _noise_grid;
+static unique_ptr<noise_grid> _noise_grid = make_unique<noise_grid>();
+// Grids that have been propagated and reset, ready to collect noises again.
+static vector<unique_ptr<noise_grid>> _spare_noise_grids;
 static void _actor_apply_noise(actor *act,
                                const coord_def &apparent_source,
                                int noise_intensity_millis);
@@ -822,16 +825,23 @@ void yell(const actor* mon)
 
 void apply_noises()
 {
-    // [ds] This copying isn't awesome, but we cannot otherwise handle
-    // the case where one set of noises wakes up monsters who then let
-    // out yips of their own, modifying _noise_grid while it is in the
+    // One set of noises can wake up monsters who then let out yips of
+    // their own, so new noises go to a fresh grid while this set is in the
     // middle of propagate_noise().
-    if (_noise_grid.dirty())
+    if (_noise_grid->dirty())
     {
-        noise_grid copy = _noise_grid;
-        // Reset the main grid.
-        _noise_grid.reset();
-        copy.propagate_noise();
+        unique_ptr<noise_grid> grid = std::move(_noise_grid);
+        if (_spare_noise_grids.empty())
+            _noise_grid = make_unique<noise_grid>();
+        else
+        {
+            _noise_grid = std::move(_spare_noise_grids.back());
+            _spare_noise_grids.pop_back();
+        }
+
+        grid->propagate_noise();
+        grid->reset();
+        _spare_noise_grids.push_back(std::move(grid));
     }
 }
 
@@ -877,7 +887,7 @@ bool noisy(int original_loudness, const coord_def& where,
     // Add +1 to scaled_loudness so that all squares adjacent to a
     // sound of loudness 1 will hear the sound.
     const string noise_msg(msg ? msg : "");
-    _noise_grid.register_noise(
+    _noise_grid->register_noise(
         noise_t(where, noise_msg, (scaled_loudness + 1) * multiplier, who,
                 fake_noise));
 
@@ -974,14 +984,29 @@ int noise_cell::turn_angle(const coord_def &next_delta) const
     return xdiff + ydiff;
 }
 
+// Noise loses at least this much crossing any cell, so a cell can't raise
+// the intensity of another cell in its own bucket.
+static int _noise_bucket(int noise_intensity_millis)
+{
+    return max(0, noise_intensity_millis) / BASE_NOISE_ATTENUATION_MILLIS;
+}
+
 noise_grid::noise_grid()
-    : cells(), noises(), affected_actor_count(0)
+    : cells(), noises(), affected_actor_count(0),
+      noisy_min(GXM, GYM), noisy_max(-1, -1), buckets()
 {
 }
 
 void noise_grid::reset()
 {
-    cells.init(noise_cell());
+    if (noisy_min.x <= noisy_max.x)
+    {
+        for (rectangle_iterator ri(noisy_min, noisy_max); ri; ++ri)
+            cells(*ri) = noise_cell();
+    }
+    noisy_min = coord_def(GXM, GYM);
+    noisy_max = coord_def(-1, -1);
+
     noises.clear();
     affected_actor_count = 0;
 }
@@ -998,9 +1023,30 @@ void noise_grid::register_noise(const noise_t &noise)
                                               noise_index,
                                               0,
                                               coord_def(0, 0));
+        noisy_min.x = min(noisy_min.x, noise.noise_source.x);
+        noisy_min.y = min(noisy_min.y, noise.noise_source.y);
+        noisy_max.x = max(noisy_max.x, noise.noise_source.x);
+        noisy_max.y = max(noisy_max.y, noise.noise_source.y);
     }
 }
 
+void noise_grid::queue_cell(const coord_def &pos)
+{
+    const unsigned int bucket = _noise_bucket(cells(pos).noise_intensity_millis);
+    if (bucket >= buckets.size())
+        buckets.resize(bucket + 1);
+    buckets[bucket].push_back(pos);
+
+    noisy_min.x = min(noisy_min.x, pos.x);
+    noisy_min.y = min(noisy_min.y, pos.y);
+    noisy_max.x = max(noisy_max.x, pos.x);
+    noisy_max.y = max(noisy_max.y, pos.y);
+}
+
+// All noises spread together, loudest cells first, so each cell takes the
+// loudest noise that reaches it and passes it on exactly once. Cells are
+// kept in buckets of intensity, the buckets being narrow enough that
+// nothing can be made louder by another cell of its own bucket.
 void noise_grid::propagate_noise()
 {
     if (noises.empty())
@@ -1010,62 +1056,60 @@ void noise_grid::propagate_noise()
     dprf(DIAG_NOISE, "noise_grid: %u noises to apply",
          (unsigned int)noises.size());
 #endif
-    vector<coord_def> noise_perimeter[2];
-    int circ_index = 0;
 
     for (const noise_t &noise : noises)
-        noise_perimeter[circ_index].push_back(noise.noise_source);
+    {
+        // A louder noise from the same place may have replaced this one.
+        if (cells(noise.noise_source).noise_id == noise.noise_id)
+            queue_cell(noise.noise_source);
+    }
 
-    int travel_distance = 0;
-    while (!noise_perimeter[circ_index].empty())
+    for (int bucket = buckets.size() - 1; bucket >= 0; --bucket)
     {
-        const vector<coord_def> &perimeter(noise_perimeter[circ_index]);
-        vector<coord_def> &next_perimeter(noise_perimeter[!circ_index]);
-        ++travel_distance;
-        for (const coord_def &p : perimeter)
+        // Cells can only be queued into lower buckets from here.
+        for (const coord_def &p : buckets[bucket])
         {
             const noise_cell &cell(cells(p));
 
-            if (!cell.silent())
-            {
-                apply_noise_effects(p,
-                                    cell.noise_intensity_millis,
-                                    noises[cell.noise_id]);
+            // Stale: the cell was made louder and has been done already.
+            if (_noise_bucket(cell.noise_intensity_millis) != bucket)
+                continue;
+
+            if (cell.silent())
+                continue;
+
+            apply_noise_effects(p,
+                                cell.noise_intensity_millis,
+                                noises[cell.noise_id]);
 
-                const int attenuation = _noise_attenuation_millis(p);
-                // If the base noise attenuation kills the noise, go no farther:
-                if (noise_is_audible(cell.noise_intensity_millis - attenuation))
+            const int attenuation = _noise_attenuation_millis(p);
+            // If the base noise attenuation kills the noise, go no farther:
+            if (!noise_is_audible(cell.noise_intensity_millis - attenuation))
+                continue;
+
+            // [ds] Not using adjacent iterator which has
+            // unnecessary overhead for the tight loop here.
+            for (int xi = -1; xi <= 1; ++xi)
+            {
+                for (int yi = -1; yi <= 1; ++yi)
                 {
-                    // [ds] Not using adjacent iterator which has
-                    // unnecessary overhead for the tight loop here.
-                    for (int xi = -1; xi <= 1; ++xi)
+                    if (!xi && !yi)
+                        continue;
+
+                    const coord_def next_position(p.x + xi, p.y + yi);
+                    if (in_bounds(next_position)
+                        && propagate_noise_to_neighbour(
+                               attenuation,
+                               cell.noise_travel_distance + 1,
+                               cell, p,
+                               next_position))
                     {
-                        for (int yi = -1; yi <= 1; ++yi)
-                        {
-                            if (xi || yi)
-                            {
-                                const coord_def next_position(p.x + xi,
-                                                              p.y + yi);
-                                if (in_bounds(next_position))
-                                {
-                                    if (propagate_noise_to_neighbour(
-                                            attenuation,
-                                            travel_distance,
-                                            cell, p,
-                                            next_position))
-                                    {
-                                        next_perimeter.push_back(next_position);
-                                    }
-                                }
-                            }
-                        }
+                        queue_cell(next_position);
                     }
                 }
             }
         }
-
-        noise_perimeter[circ_index].clear();
-        circ_index = !circ_index;
+        buckets[bucket].clear();
     }
 
 #ifdef DEBUG_NOISE_PROPAGATION
@@ -1100,14 +1144,18 @@ bool noise_grid::propagate_noise_to_neighbour(int base_attenuation,
         cell.noise_intensity_millis - turn_attenuation;
     if (noise_is_audible(attenuated_noise_intensity))
     {
-        const int neighbour_old_distance = neighbour.noise_travel_distance;
+        const int neighbour_old_bucket =
+            _noise_bucket(neighbour.noise_intensity_millis);
         if (neighbour.apply_noise(attenuated_noise_intensity,
                                   cell.noise_id,
                                   travel_distance,
                                   next_pos - current_pos))
-            // Return true only if we hadn't already registered this
-            // cell as a neighbour (presumably with a lower volume).
-            return neighbour_old_distance != travel_distance;
+        {
+            // Return true only if the cell isn't already queued in the
+            // same bucket (presumably with a lower volume).
+            return neighbour_old_bucket
+                   != _noise_bucket(attenuated_noise_intensity);
+        }
     }
     return false;
 }
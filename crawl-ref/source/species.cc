@@ -677,6 +677,7 @@ static void _swap_equip(equipment_type a, equipment_type b)
     bool tmp = you.melded[a];
     you.melded.set(a, you.melded[b]);
     you.melded.set(b, tmp);
+    you.invalidate_artefact_totals();
 }
 
 /**
@@ -770,6 +771,7 @@ void change_species_to(species_type sp)
             // Unwear items without the usual processing.
             you.equip[i] = -1;
             you.melded.set(i, false);
+            you.invalidate_artefact_totals();
         }
 
     // Sanitize skills.
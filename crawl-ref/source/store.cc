@@ -9,11 +9,14 @@
 #include "store.h"
 
 #include <algorithm>
+#include <cstring>
+#include <unordered_map>
 
 #include "dlua.h"
 #include "monster.h"
 #include "stringutil.h"
 #include "tag-version.h"
+#include "threads.h"
 
 // These tend to be called from tight loops, and C++ method calls don't
 // get optimized away except for LTO -fwhole-program builds, so merely
@@ -1262,6 +1265,141 @@ static map<string, int> accesses;
 //////////////////
 // Misc functions
 
+// Numbers are handed out under a lock, but each thread remembers the
+// numbers of the key literals it has looked up by their address, so that
+// most lookups needn't take it. The address might since have been reused
+// for another string, so the name is checked as well.
+struct store_key_names
+{
+    mutex_t lock;
+    // Node-based, so the names stay put for the caches to point at.
+    unordered_map<string, store_key_id> ids;
+
+    store_key_names() { mutex_init(lock); }
+};
+
+static store_key_id _key_number(const string &key, const string **name)
+{
+    static store_key_names names;
+    mutex_lock(names.lock);
+    auto it = names.ids.find(key);
+    if (it == names.ids.end())
+        it = names.ids.emplace(key, names.ids.size()).first;
+    if (name)
+        *name = &it->first;
+    mutex_unlock(names.lock);
+    return it->second;
+}
+
+store_key_id store_key_number(const string &key)
+{
+    return _key_number(key, nullptr);
+}
+
+#define KEY_CACHE_BITS 10
+
+store_key_id store_key_number(const char *key)
+{
+    struct cached_key
+    {
+        const char *addr;
+        const string *name;
+        store_key_id id;
+    };
+    static thread_local cached_key cache[1 << KEY_CACHE_BITS];
+
+    // Literals are packed together, so mix up the low bits.
+    const uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key))
+                          * 0x9E3779B97F4A7C15ULL;
+    cached_key &c = cache[hash >> (64 - KEY_CACHE_BITS)];
+    if (c.addr == key && *c.name == key)
+        return c.id;
+
+    c.addr = key;
+    c.id = _key_number(key, &c.name);
+    return c.id;
+}
+
+CrawlHashTable::CrawlHashTable(const CrawlHashTable &other)
+    : map(other)
+{
+    // Our keys have the same numbers as theirs.
+    ids.reserve(other.ids.size());
+    for (const key_entry &entry : other.ids)
+        ids.emplace_back(entry.first, find(entry.second->first));
+}
+
+CrawlHashTable& CrawlHashTable::operator=(CrawlHashTable other)
+{
+    swap(other);
+    return *this;
+}
+
+void CrawlHashTable::swap(CrawlHashTable &other)
+{
+    // Iterators stay good, now pointing into the other table.
+    map::swap(other);
+    ids.swap(other.ids);
+}
+
+static bool _id_less(const pair<store_key_id, CrawlHashTable::iterator> &entry,
+                     store_key_id id)
+{
+    return entry.first < id;
+}
+
+CrawlHashTable::iterator CrawlHashTable::find_id(store_key_id id) const
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), id, _id_less);
+    if (it == ids.end() || it->first != id)
+        return const_cast<CrawlHashTable*>(this)->end();
+    return it->second;
+}
+
+CrawlHashTable::iterator CrawlHashTable::add(iterator hint, const string &key,
+                                             store_key_id id)
+{
+    iterator added = map::emplace_hint(hint, key, CrawlStoreValue());
+    ids.emplace(std::lower_bound(ids.begin(), ids.end(), id, _id_less),
+                id, added);
+    return added;
+}
+
+CrawlHashTable::iterator CrawlHashTable::erase(const_iterator pos)
+{
+    for (auto it = ids.begin(); it != ids.end(); ++it)
+        if (it->second == pos)
+        {
+            ids.erase(it);
+            break;
+        }
+    return map::erase(pos);
+}
+
+CrawlHashTable::size_type CrawlHashTable::erase(const string &key)
+{
+    auto it = find(key);
+    if (it == end())
+        return 0;
+    erase(it);
+    return 1;
+}
+
+CrawlHashTable::size_type CrawlHashTable::erase(const char *key)
+{
+    auto it = find_id(store_key_number(key));
+    if (it == end())
+        return 0;
+    erase(it);
+    return 1;
+}
+
+void CrawlHashTable::clear()
+{
+    map::clear();
+    ids.clear();
+}
+
 bool CrawlHashTable::exists(const string &key) const
 {
     ACCESS(key);
@@ -1269,6 +1407,13 @@ bool CrawlHashTable::exists(const string &key) const
     return find(key) != end();
 }
 
+bool CrawlHashTable::exists(const char *key) const
+{
+    ACCESS(key);
+    ASSERT_VALIDITY();
+    return find_id(store_key_number(key)) != end();
+}
+
 void CrawlHashTable::assert_validity() const
 {
 #ifdef DEBUG
@@ -1338,15 +1483,27 @@ CrawlStoreValue& CrawlHashTable::get_value(const string &key)
     ASSERT_VALIDITY();
     ACCESS(key);
     // Inserts CrawlStoreValue() if the key was not found.
-    return map::operator[](key);
+    auto iter = lower_bound(key);
+    if (iter == end() || iter->first != key)
+        iter = add(iter, key, store_key_number(key));
+    return iter->second;
 }
 
-const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
+CrawlStoreValue& CrawlHashTable::get_value(const char *key)
 {
     ASSERT_VALIDITY();
     ACCESS(key);
-    auto iter = find(key);
-    ASSERTM(iter != end(), "trying to read non-existent property \"%s\"", key.c_str());
+    const store_key_id id = store_key_number(key);
+    auto iter = find_id(id);
+    if (iter == end())
+        iter = add(end(), key, id);
+    return iter->second;
+}
+
+const CrawlStoreValue& CrawlHashTable::existing_value(const_iterator iter,
+                                                      const char *key) const
+{
+    ASSERTM(iter != end(), "trying to read non-existent property \"%s\"", key);
 
     const CrawlStoreValue& store = iter->second;
     ASSERT(store.type != SV_NONE);
@@ -1355,6 +1512,20 @@ const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
     return store;
 }
 
+const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
+{
+    ASSERT_VALIDITY();
+    ACCESS(key);
+    return existing_value(find(key), key.c_str());
+}
+
+const CrawlStoreValue& CrawlHashTable::get_value(const char *key) const
+{
+    ASSERT_VALIDITY();
+    ACCESS(key);
+    return existing_value(find_id(store_key_number(key)), key);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -241,27 +241,48 @@ protected:
     friend class CrawlVector;
 };
 
+// Every props key gets a number the first time it is seen, the same on all
+// threads for the rest of the run (but never saved). Besides its map, each
+// table keeps the numbers of its keys in a sorted array, so that a lookup
+// by one of the *_KEY literals that nearly all props accesses use is a
+// binary search over integers rather than string comparisons down the
+// tree. The map is still what is iterated, and what Lua and saves use.
+typedef uint32_t store_key_id;
+store_key_id store_key_number(const string &key);
+store_key_id store_key_number(const char *key);
+
 class CrawlHashTable : public map<string, CrawlStoreValue>
 {
 public:
     friend class CrawlStoreValue;
 
+    CrawlHashTable() {}
+    CrawlHashTable(const CrawlHashTable &other);
+    CrawlHashTable(CrawlHashTable &&other) = default;
+    CrawlHashTable& operator=(CrawlHashTable other);
+
     void write(writer &) const;
     void read(reader &);
 
     bool exists(const string &key) const;
+    bool exists(const char *key) const;
+
+    size_type erase(const string &key);
+    size_type erase(const char *key);
+    iterator erase(const_iterator pos);
+    void clear();
+    void swap(CrawlHashTable &other);
 
     void assert_validity() const;
 
     // NOTE: If the const versions of get_value() or [] are given a
     // key which doesn't exist, they will assert.
     const CrawlStoreValue& get_value(const string &key) const;
-    const CrawlStoreValue& get_value(const char *key) const
-    { return get_value(string(key)); }
+    const CrawlStoreValue& get_value(const char *key) const;
     const CrawlStoreValue& operator[] (const string &key) const
     { return get_value(key); }
     const CrawlStoreValue& operator[] (const char *key) const
-    { return get_value(string(key)); }
+    { return get_value(key); }
 
     // NOTE: If get_value() or [] is given a key which doesn't exist
     // in the table, an unset/empty CrawlStoreValue will be created
@@ -271,11 +292,26 @@ public:
     // then trying to assign a different type to the CrawlStoreValue
     // will assert.
     CrawlStoreValue& get_value(const string &key);
-    CrawlStoreValue& get_value(const char *key)
-    { return get_value(string(key)); }
-    using map::operator[];
+    CrawlStoreValue& get_value(const char *key);
+    CrawlStoreValue& operator[] (const string &key)
+    { return get_value(key); }
     CrawlStoreValue& operator[] (const char *key)
-    { return get_value(string(key)); }
+    { return get_value(key); }
+
+private:
+    // Everything that adds or removes keys has to keep ids up to date.
+    using map::insert;
+    using map::emplace;
+    using map::emplace_hint;
+
+    // The number of each key in the map, sorted by number.
+    typedef pair<store_key_id, iterator> key_entry;
+    vector<key_entry> ids;
+
+    iterator find_id(store_key_id id) const;
+    iterator add(iterator hint, const string &key, store_key_id id);
+    const CrawlStoreValue& existing_value(const_iterator iter,
+                                          const char *key) const;
 };
 
 // A CrawlVector is the vector version of CrawlHashTable, except that
@@ -288,6 +288,7 @@ enum tag_minor_version
     TAG_MINOR_SLENGU,              // Split tengu mutations.
     TAG_MINOR_GLASS_EYES,          // Fixup paralysis gaze to vitrifying gaze.
     TAG_MINOR_SAVE_TALISMANS,      // Store the in-use talisman.
+    TAG_MINOR_STAIR_DIST_TRIANGLE, // Save only half the stair distances.
 #endif
     NUM_TAG_MINORS,
     TAG_MINOR_VERSION = NUM_TAG_MINORS - 1
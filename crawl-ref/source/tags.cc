@@ -114,7 +114,7 @@ extern set<pair<string, level_id> > auto_unique_annotations;
 extern abyss_state abyssal_state;
 
 reader::reader(const string &_read_filename, int minorVersion)
-    : _filename(_read_filename), _chunk(0), _pbuf(nullptr), _read_offset(0),
+    : _filename(_read_filename), _chunk(0), _pbuf(nullptr), _cur(0), _end(0),
       _minorVersion(minorVersion), _safe_read(false)
 {
     _file       = fopen_u(_filename.c_str(), "rb");
@@ -122,11 +122,12 @@ reader::reader(const string &_read_filename, int minorVersion)
 }
 
 reader::reader(package *save, const string &chunkname, int minorVersion)
-    : _file(0), _chunk(0), opened_file(false), _pbuf(0), _read_offset(0),
+    : _file(0), _chunk(0), opened_file(false), _pbuf(0), _cur(0), _end(0),
      _minorVersion(minorVersion), _safe_read(false)
 {
     ASSERT(save);
     _chunk = new chunk_reader(save, chunkname);
+    _stage.resize(MARSHALL_BUFFER_SIZE);
 }
 
 reader::~reader()
@@ -158,7 +159,7 @@ void reader::advance(size_t offset)
 bool reader::valid() const
 {
     return (_file && !feof(_file)) ||
-           (_pbuf && _read_offset < _pbuf->size());
+           (_pbuf && _cur < _end);
 }
 
 static NORETURN void _short_read(bool safe_read)
@@ -170,8 +171,19 @@ static NORETURN void _short_read(bool safe_read)
     die_noline("short read while reading save");
 }
 
-// Reads input in network byte order, from a file or buffer.
-unsigned char reader::readByte()
+// Decompress the next block of a chunk into the staging buffer.
+bool reader::refill()
+{
+    ASSERT(_chunk);
+    const plen_t got = _chunk->read(_stage.data(), _stage.size());
+    _cur = _stage.data();
+    _end = _cur + got;
+    return got;
+}
+
+// Reads input in network byte order, from a file or buffer. readByte()
+// handles the case where there is already staged input.
+unsigned char reader::read_byte_slow()
 {
     if (_file)
     {
@@ -180,19 +192,10 @@ unsigned char reader::readByte()
             _short_read(_safe_read);
         return b;
     }
-    else if (_chunk)
-    {
-        unsigned char buf;
-        if (_chunk->read(&buf, 1) != 1)
-            _short_read(_safe_read);
-        return buf;
-    }
+    else if (_chunk && refill())
+        return *_cur++;
     else
-    {
-        if (_read_offset >= _pbuf->size())
-            _short_read(_safe_read);
-        return (*_pbuf)[_read_offset++];
-    }
+        _short_read(_safe_read);
 }
 
 void reader::read(void *data, size_t size)
@@ -206,21 +209,40 @@ void reader::read(void *data, size_t size)
         }
         else
             fseek(_file, (long)size, SEEK_CUR);
+        return;
     }
-    else if (_chunk)
+
+    unsigned char *out = static_cast<unsigned char *>(data);
+    size_t avail = _end - _cur;
+    if (_chunk)
     {
-        if (_chunk->read(data, size) != size)
-            _short_read(_safe_read);
+        while (size > avail)
+        {
+            if (out && avail)
+            {
+                memcpy(out, _cur, avail);
+                out += avail;
+            }
+            _cur += avail;
+            size -= avail;
+            // Big reads don't need to go through the staging buffer.
+            if (out && size >= _stage.size())
+            {
+                if (_chunk->read(out, size) != size)
+                    _short_read(_safe_read);
+                return;
+            }
+            if (!refill())
+                _short_read(_safe_read);
+            avail = _end - _cur;
+        }
     }
-    else
-    {
-        if (_read_offset+size > _pbuf->size())
-            _short_read(_safe_read);
-        if (data && size)
-            memcpy(data, &(*_pbuf)[_read_offset], size);
+    else if (size > avail)
+        _short_read(_safe_read);
 
-        _read_offset += size;
-    }
+    if (out && size)
+        memcpy(out, _cur, size);
+    _cur += size;
 }
 
 int reader::getMinorVersion() const
@@ -236,10 +258,9 @@ void reader::setMinorVersion(int minorVersion)
 
 void reader::fail_if_not_eof(const string &name)
 {
-    char dummy;
-    if (_chunk ? _chunk->read(&dummy, 1) :
+    if (_chunk ? _cur < _end || refill() :
         _file ? (fgetc(_file) != EOF) :
-        _read_offset >= _pbuf->size())
+        _cur < _end)
     {
         fail("Incomplete read of \"%s\" - aborting.", name.c_str());
     }
@@ -255,17 +276,14 @@ void writer::check_ok(bool ok)
     }
 }
 
-void writer::writeByte(unsigned char ch)
+// Hand anything staged by writeByte() or write() on to the chunk.
+void writer::flush()
 {
-    if (failed)
-        return;
-
-    if (_chunk)
-        _chunk->write(&ch, 1);
-    else if (_file)
-        check_ok(fputc(ch, _file) != EOF);
-    else
-        _pbuf->push_back(ch);
+    if (_chunk && _staged)
+    {
+        _chunk->write(_stage.data(), _staged);
+        _staged = 0;
+    }
 }
 
 void writer::write(const void *data, size_t size)
@@ -274,7 +292,17 @@ void writer::write(const void *data, size_t size)
         return;
 
     if (_chunk)
-        _chunk->write(data, size);
+    {
+        if (_staged + size > MARSHALL_BUFFER_SIZE)
+            flush();
+        if (size >= MARSHALL_BUFFER_SIZE)
+            _chunk->write(data, size);
+        else
+        {
+            memcpy(_stage.data() + _staged, data, size);
+            _staged += size;
+        }
+    }
     else if (_file)
         check_ok(fwrite(data, 1, size, _file) == size);
     else
@@ -1288,6 +1316,7 @@ static void _shunt_monsters_out_of_walls()
                          m.pos().x, m.pos().y);
                     env.mgrid(m.pos()) = NON_MONSTER;
                     m.position = *di;
+                    m.sync_hot_position();
                     env.mgrid(*di) = i;
                     break;
                 }
@@ -4334,6 +4363,7 @@ static void _tag_read_you_items(reader &th)
                 you.unrand_reacts.set(i);
         }
     }
+    you.invalidate_artefact_totals();
 
     _unmarshallFixedBitVector<NUM_RUNE_TYPES>(th, you.runes);
     you.obtainable_runes = unmarshallByte(th);
@@ -4936,9 +4966,8 @@ static void _tag_construct_level(writer &th)
 
     // how many clouds?
     marshallShort(th, env.cloud.size());
-    for (const auto& entry : env.cloud)
+    for (const cloud_struct& cloud : env.cloud)
     {
-        const cloud_struct& cloud = entry.second;
         marshallByte(th, cloud.type);
         ASSERT(cloud.type != CLOUD_NONE);
         ASSERT_IN_BOUNDS(cloud.pos);
@@ -5032,7 +5061,21 @@ void marshallItem(writer &th, const item_def &item, bool iinfo)
     marshallShort(th, item.orig_monnum);
     marshallString(th, item.inscription);
 
-    item.props.write(th);
+    if (!item.art_props)
+    {
+        item.props.write(th);
+        return;
+    }
+
+    // Artefact properties are saved in props, as they always were;
+    // artefact_fixup_props() moves them back out on load.
+    CrawlHashTable props = item.props;
+    CrawlVector &rap = props[ARTEFACT_PROPS_KEY].new_vector(SV_SHORT);
+    rap.resize(ART_PROPERTIES);
+    rap.set_max_size(ART_PROPERTIES);
+    for (vec_size i = 0; i < ART_PROPERTIES; i++)
+        rap[i] = item.art_props[i];
+    props.write(th);
 }
 
 #if TAG_MAJOR_VERSION == 34
@@ -5145,6 +5188,7 @@ void unmarshallItem(reader &th, item_def &item)
     item.inscription = unmarshallString(th);
 
     item.props.clear();
+    item.art_props.reset();
     item.props.read(th);
 #if TAG_MAJOR_VERSION == 34
     if (th.getMinorVersion() < TAG_MINOR_CORPSE_COLOUR
@@ -5408,7 +5452,7 @@ void unmarshallItem(reader &th, item_def &item)
     {
         int acc, dam, slay = 0;
 
-        if (item.props.exists(ARTEFACT_PROPS_KEY))
+        if (item.art_props)
         {
             acc = artefact_property(item, ARTP_ACCURACY);
             dam = artefact_property(item, ARTP_SLAYING);
@@ -7332,6 +7376,7 @@ static void _tag_read_level_monsters(reader &th)
     {
         monster& m = env.mons[i];
         unmarshallMonster(th, m);
+        env.mons_in_use.set(i, m.type != MONS_NO_MONSTER);
 
         // place monster
         if (!m.alive())
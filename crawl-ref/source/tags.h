@@ -49,30 +49,54 @@ enum tag_type   // used during save/load process to identify data blocks
  * writer API
  * *********************************************************************** */
 
+// Bytes written to or read from a save chunk are staged in blocks of this
+// size, rather than going through the compressor one at a time.
+#define MARSHALL_BUFFER_SIZE 16384
+
 class writer
 {
 public:
     writer(const string &filename, FILE* output, bool ignore_errors = false)
         : _filename(filename), _file(output), _chunk(0),
-          _ignore_errors(ignore_errors), _pbuf(0), failed(false)
+          _ignore_errors(ignore_errors), _pbuf(0), _staged(0), failed(false)
     {
         ASSERT(output);
     }
     writer(vector<unsigned char>* poutput)
         : _filename(), _file(0), _chunk(0), _ignore_errors(false),
-          _pbuf(poutput), failed(false) { ASSERT(poutput); }
+          _pbuf(poutput), _staged(0), failed(false) { ASSERT(poutput); }
     writer(package *save, const string &chunkname)
         : _filename(), _file(0), _chunk(0), _ignore_errors(false),
-          failed(false)
+          _pbuf(0), _stage(MARSHALL_BUFFER_SIZE), _staged(0), failed(false)
     {
         ASSERT(save);
         _chunk = save->writer(chunkname);
     }
 
-    ~writer() { if (_chunk) delete _chunk; }
+    ~writer()
+    {
+        if (_chunk)
+        {
+            flush();
+            delete _chunk;
+        }
+    }
 
-    void writeByte(unsigned char byte);
+    void writeByte(unsigned char byte)
+    {
+        if (_chunk)
+        {
+            if (_staged == MARSHALL_BUFFER_SIZE)
+                flush();
+            _stage[_staged++] = byte;
+        }
+        else if (_pbuf)
+            _pbuf->push_back(byte);
+        else
+            write(&byte, 1);
+    }
     void write(const void *data, size_t size);
+    void flush();
     long tell();
 
     bool succeeded() const { return !failed; }
@@ -88,6 +112,10 @@ private:
 
     vector<unsigned char>* _pbuf;
 
+    // Pending output for _chunk; empty for other writers.
+    vector<unsigned char> _stage;
+    size_t _staged;
+
     bool failed;
 };
 
@@ -116,16 +144,22 @@ public:
     reader(const string &filename, int minorVersion = TAG_MINOR_INVALID);
     reader(FILE* input, int minorVersion = TAG_MINOR_INVALID)
         : _file(input), _chunk(0), opened_file(false), _pbuf(0),
-          _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
+          _cur(0), _end(0), _minorVersion(minorVersion), _safe_read(false) {}
     reader(const vector<unsigned char>& input,
            int minorVersion = TAG_MINOR_INVALID)
         : _file(0), _chunk(0), opened_file(false), _pbuf(&input),
-          _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
+          _cur(input.data()), _end(input.data() + input.size()),
+          _minorVersion(minorVersion), _safe_read(false) {}
     reader(package *save, const string &chunkname,
            int minorVersion = TAG_MINOR_INVALID);
     ~reader();
 
-    unsigned char readByte();
+    unsigned char readByte()
+    {
+        if (_cur < _end)
+            return *_cur++;
+        return read_byte_slow();
+    }
     void read(void *data, size_t size);
     void advance(size_t size);
     int getMinorVersion() const;
@@ -138,13 +172,20 @@ public:
 
     void set_safe_read(bool setting) { _safe_read = setting; }
 
+private:
+    unsigned char read_byte_slow();
+    bool refill();
+
 private:
     string _filename;
     FILE* _file;
     chunk_reader *_chunk;
     bool  opened_file;
     const vector<unsigned char>* _pbuf;
-    unsigned int _read_offset;
+    // Unread input: the rest of *_pbuf, or what has been decompressed from
+    // _chunk into _stage but not yet consumed.
+    const unsigned char *_cur, *_end;
+    vector<unsigned char> _stage;
     int _minorVersion;
     // always throw an exception rather than dying when reading past EOF
     bool _safe_read;
@@ -13,6 +13,7 @@
 
 #include "areas.h"
 #include "attack.h"
+#include "beam.h"
 #include "branch.h"
 #include "cloud.h"
 #include "coord.h"
@@ -35,6 +36,7 @@
 #include "mapmark.h"
 #include "message.h"
 #include "mon-behv.h"
+#include "mon-pathfind.h"
 #include "mon-place.h"
 #include "mon-poly.h"
 #include "mon-util.h"
@@ -1966,6 +1968,8 @@ void set_terrain_changed(const coord_def p)
     dungeon_events.fire_position_event(DET_FEAT_CHANGE, p);
 
     los_terrain_changed(p);
+    reset_flow_fields();
+    invalidate_tracer_cache();
 }
 
 /**
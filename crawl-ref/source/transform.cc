@@ -2151,6 +2151,7 @@ void unset_default_form()
 
     you.default_form = transformation::none;
     you.active_talisman.clear();
+    you.invalidate_artefact_totals();
 }
 
 void set_default_form(transformation t, const item_def *source)
@@ -2159,6 +2160,7 @@ void set_default_form(transformation t, const item_def *source)
         unequip_artefact_effect(you.active_talisman, nullptr, false, EQ_NONE, false);
 
     you.default_form = t;
+    you.invalidate_artefact_totals();
     if (source)
     {
         you.active_talisman = *source; // iffy
@@ -16,6 +16,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <memory>
+#include <queue>
 #include <set>
 #include <sstream>
 
@@ -909,6 +910,145 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Reusing the travel flood between steps
+//
+// Travel and autoexplore move one square at a time, and each step floods
+// the level from the destination back out to the player. That flood is
+// deterministic: while nothing it looked at changes, a new flood would
+// examine squares in exactly the same order, and stop at the first one
+// next to the player. So we remember the order from the last flood and,
+// as long as the squares in view look the same as they did then, read
+// the next step off it. Squares out of view are assumed not to change;
+// the remembered flood is dropped whenever travel stops.
+
+// A travel_pathfind that notes down the order it examines squares in.
+class recording_travel_pathfind : public travel_pathfind
+{
+public:
+    recording_travel_pathfind(FixedArray<int, GXM, GYM> &order)
+        : examined(0), exam_order(order)
+    {
+        exam_order.init(0);
+    }
+
+    int examined;
+
+protected:
+    bool point_traverse_delay(const coord_def &c) override
+    {
+        if (travel_pathfind::point_traverse_delay(c))
+            return true;
+        if (!exam_order(c))
+            exam_order(c) = ++examined;
+        return false;
+    }
+
+private:
+    FixedArray<int, GXM, GYM> &exam_order;
+};
+
+struct travel_flood_memory
+{
+    bool valid = false;
+    level_id place;
+    coord_def target;
+    unsigned int exclusions = 0;
+    bool slime_immune = false;
+    // The examination number of the square that found the player; only
+    // squares up to there were examined in the same order a new flood
+    // would use.
+    int found_at = 0;
+    FixedArray<int, GXM, GYM> exam_order;
+    FixedArray<uint32_t, GXM, GYM> digest;
+};
+
+static travel_flood_memory travel_flood;
+
+// Everything is_travelsafe_square() looks at in the map knowledge.
+static uint32_t _travel_digest(const coord_def &c)
+{
+    const map_cell &cell = env.map_knowledge(c);
+    if (!cell.known())
+        return 0;
+
+    const monster_info *mi = cell.monsterinfo();
+    return 1
+           | static_cast<uint32_t>(cell.feat()) << 1
+           | static_cast<uint32_t>(cell.cloud()) << 9
+           | static_cast<uint32_t>(cell.trap()) << 17
+           | static_cast<uint32_t>(mi && _monster_blocks_travel(mi)) << 25;
+}
+
+static unsigned int _exclusion_signature()
+{
+    unsigned int sig = curr_excludes.size();
+    for (const auto &entry : curr_excludes)
+    {
+        sig = sig * 31 + (entry.first.x * GYM + entry.first.y) * 16
+              + entry.second.radius;
+    }
+    return sig;
+}
+
+// The next step towards target, as a travel flood without fallback would
+// find it, or the origin if there's no such step.
+static coord_def _travel_flood_step(const coord_def &youpos,
+                                    const coord_def &target)
+{
+    travel_flood_memory &tf = travel_flood;
+    if (tf.valid
+        && tf.place == level_id::current()
+        && tf.target == target
+        && tf.exclusions == _exclusion_signature()
+        && tf.slime_immune == actor_slime_wall_immune(&you)
+        && youpos != target
+        // Transporters can find the player from afar.
+        && env.grid(youpos) != DNGN_TRANSPORTER)
+    {
+        bool unchanged = true;
+        for (rectangle_iterator ri(youpos, LOS_MAX_RANGE, true);
+             ri && unchanged; ++ri)
+        {
+            unchanged = _travel_digest(*ri) == tf.digest(*ri);
+        }
+
+        if (unchanged)
+        {
+            coord_def best;
+            int best_order = tf.found_at + 1;
+            for (adjacent_iterator ai(youpos); ai; ++ai)
+            {
+                const int order = tf.exam_order(*ai);
+                if (order > 0 && order < best_order)
+                {
+                    best = *ai;
+                    best_order = order;
+                }
+            }
+            if (best_order <= tf.found_at && _is_safe_move(best))
+                return best;
+        }
+    }
+
+    tf.valid = false;
+    recording_travel_pathfind tp(tf.exam_order);
+    tp.set_src_dst(youpos, target);
+    const coord_def move = tp.pathfind(RMODE_TRAVEL, false);
+    if (move.origin())
+        return move;
+
+    tf.valid = true;
+    tf.place = level_id::current();
+    tf.target = target;
+    tf.exclusions = _exclusion_signature();
+    tf.slime_immune = actor_slime_wall_immune(&you);
+    tf.found_at = tp.examined;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        tf.digest(*ri) = _travel_digest(*ri);
+    return move;
+}
+
 /**
  * Run the travel_pathfind algorithm with a destination with the aim of
  * determining the next travel move. Try to avoid to let travel (including
@@ -927,13 +1067,13 @@ void explore_pickup_event(int did_pickup, int tried_pickup)
  */
 static void _find_travel_pos(const coord_def& youpos, int *move_x, int *move_y)
 {
-    travel_pathfind tp;
-
-    tp.set_src_dst(youpos, you.running.pos);
-
-    coord_def dest = tp.pathfind(RMODE_TRAVEL, false);
+    coord_def dest = _travel_flood_step(youpos, you.running.pos);
     if (dest.origin())
+    {
+        travel_pathfind tp;
+        tp.set_src_dst(youpos, you.running.pos);
         dest = tp.pathfind(RMODE_TRAVEL, true);
+    }
     coord_def new_dest = dest;
 
     // We'd either have to travel through a runed door, in which case we'll be
@@ -2951,11 +3091,35 @@ static int _target_distance_from(const coord_def &pos)
     return -1;
 }
 
+// A place interlevel travel can get to: somewhere on a level, or the
+// target itself.
+struct transtravel_step
+{
+    int distance;
+    unsigned int order;     // Ties go to the first found.
+    level_id level;
+    coord_def pos;
+    coord_def first_stair;  // What to head for on the player's level.
+    bool at_target;
+
+    bool operator<(const transtravel_step &other) const
+    {
+        // Reversed, so priority_queue pops the closest first.
+        return distance != other.distance ? distance > other.distance
+                                          : order > other.order;
+    }
+};
+
 /*
  * Sets best_stair to the coordinates of the best stair on the player's current
- * level to take to get to the 'target' level. Should be called with 'distance'
- * set to 0, 'stair' set to (you.x_pos, you.y_pos) and 'best_distance' set to
- * -1. 'cur' should be the player's current level.
+ * level to take to get to the 'target' level. Should be called with 'stair'
+ * set to (you.x_pos, you.y_pos) and 'best_level_distance' set to -1. 'cur'
+ * should be the player's current level. Returns the travel distance to the
+ * target, or -1 if there's no known way there.
+ *
+ * This is Dijkstra's algorithm over the stairs of all known levels: on each
+ * level the precomputed stair distances give the cost of walking between
+ * stairs (including by transporter), and taking a stair costs 500.
  *
  * If best_stair remains unchanged when this function returns, there is no
  * travel-safe path between the player's current level and the target level OR
@@ -2963,131 +3127,139 @@ static int _target_distance_from(const coord_def &pos)
  *
  * This function relies on the travel_point_distance array being correctly
  * populated with a floodout call to find_travel_pos starting from the player's
- * location.
+ * location, and on the stair distances having been cleared.
  *
  * This function has undefined behaviour when the target position is not
  * traversable.
  */
 static int _find_transtravel_stair(const level_id &cur,
                                     const level_pos &target,
-                                    int distance,
                                     // This is actually the current position
                                     // on cur, not necessarily a stair.
                                     const coord_def &stair,
                                     level_id &closest_level,
                                     int &best_level_distance,
-                                    coord_def &best_stair,
-                                    int search_depth = 0)
+                                    coord_def &best_stair)
 {
-    int local_distance = -1;
-    level_id player_level = level_id::current();
+    const level_id player_level = level_id::current();
+    const coord_def nowhere(-1, -1);
 
-    LevelInfo &li = travel_cache.get_level_info(cur);
+    priority_queue<transtravel_step> frontier;
+    unsigned int found = 0;
+    frontier.push({0, found++, cur, stair, nowhere, false});
 
-    // Have we reached the target level?
-    if (cur == target.id)
+    while (!frontier.empty())
     {
-        // Are we in an exclude? If so, bail out. Unless it is just a stair exclusion.
-        if (is_excluded(stair, li.get_excludes()) && !is_stair_exclusion(stair))
-            return -1;
-
-        // If there's no target position on the target level, or we're on the
-        // target, we're home.
-        if (target.pos.x == -1 || target.pos == stair)
-            return distance;
+        const transtravel_step step = frontier.top();
+        frontier.pop();
 
-        // If there *is* a target position, we need to work out our distance
-        // from it.
-        int deltadist = _target_distance_from(stair);
-
-        if (deltadist == -1 && cur == player_level)
+        if (step.at_target)
         {
-            // Okay, we don't seem to have a distance available to us, which
-            // means we're either (a) not standing on stairs or (b) whoever
-            // initiated interlevel travel didn't call
-            // _populate_stair_distances. Assuming we're not on stairs, that
-            // situation can arise only if interlevel travel has been triggered
-            // for a location on the same level. If that's the case, we can get
-            // the distance off the travel_point_distance matrix.
-            deltadist = travel_point_distance[target.pos.x][target.pos.y];
-            if (!deltadist && stair != target.pos)
-                deltadist = -1;
+            if (step.first_stair != nowhere)
+                best_stair = step.first_stair;
+            return step.distance;
         }
 
-        if (deltadist != -1)
-        {
-            local_distance = distance + deltadist;
-
-            // See if this is a degenerate case of interlevel travel:
-            // A degenerate case of interlevel travel decays to normal travel;
-            // we identify this by checking if:
-            // a. The current level is the target level.
-            // b. The target square is reachable from the 'current' square.
-            // c. The current square is where the player is.
-            //
-            // Note that even if this *is* degenerate, interlevel travel may
-            // still be able to find a shorter route, since it can consider
-            // routes that leave and reenter the current level.
-            if (player_level == target.id && stair == you.pos())
-                best_stair = target.pos;
-
-            // The local_distance is already set, but there may actually be
-            // stairs we can take that'll get us to the target faster than the
-            // direct route, so we also try the stairs.
-        }
-    }
+        // Only the starting position has no first stair yet.
+        const bool start = step.first_stair == nowhere;
+        LevelInfo &li = travel_cache.get_level_info(step.level);
 
-    vector<stair_info> &stairs = li.get_stairs();
+        // this_stair being nullptr is perfectly acceptable, since we start
+        // with coords as the player coords, and the player need not be
+        // standing on stairs.
+        stair_info *this_stair = li.get_stair(step.pos);
 
-    // this_stair being nullptr is perfectly acceptable, since we start with
-    // coords as the player coords, and the player need not be standing on
-    // stairs.
-    stair_info *this_stair = li.get_stair(stair);
+        // Have we already been here by a shorter way?
+        if (!start && this_stair && this_stair->distance < step.distance)
+            continue;
 
-    if (!this_stair && cur != player_level)
-    {
-        // Whoops, there's no stair in the travel cache for the current
-        // position, and we're not on the player's current level (i.e., there
-        // certainly *should* be a stair here). Since we can't proceed in any
-        // reasonable way, bail out.
-        return local_distance;
-    }
+        // Have we reached the target level?
+        if (step.level == target.id)
+        {
+            // Are we in an exclude? If so, bail out. Unless it is just a
+            // stair exclusion.
+            if (is_excluded(step.pos, li.get_excludes())
+                && !is_stair_exclusion(step.pos))
+            {
+                continue;
+            }
 
-    for (stair_info &si : stairs)
-    {
-        if (stairs_destination_is_excluded(si))
-            continue;
+            // If there's no target position on the target level, or we're
+            // on the target, we're home.
+            if (target.pos.x == -1 || target.pos == step.pos)
+            {
+                if (!start)
+                    best_stair = step.first_stair;
+                return step.distance;
+            }
 
-        // Skip placeholders and excluded stairs.
-        if (!si.can_travel() || is_excluded(si.position, li.get_excludes()))
-            continue;
+            // If there *is* a target position, we need to work out our
+            // distance from it.
+            int deltadist = _target_distance_from(step.pos);
 
-        int deltadist = li.distance_between(this_stair, &si);
+            if (deltadist == -1 && step.level == player_level)
+            {
+                // Okay, we don't seem to have a distance available to us,
+                // which means we're either (a) not standing on stairs or (b)
+                // whoever initiated interlevel travel didn't call
+                // _populate_stair_distances. Assuming we're not on stairs,
+                // that situation can arise only if interlevel travel has been
+                // triggered for a location on the same level. If that's the
+                // case, we can get the distance off the travel_point_distance
+                // matrix.
+                deltadist = travel_point_distance[target.pos.x][target.pos.y];
+                if (!deltadist && step.pos != target.pos)
+                    deltadist = -1;
+            }
 
-        if (!this_stair)
-        {
-            deltadist = travel_point_distance[si.position.x][si.position.y];
-            if (!deltadist && you.pos() != si.position)
-                deltadist = -1;
+            // Even if the target is reachable from here, there may be stairs
+            // we can take that'll get us there faster than the direct route,
+            // so we also try the stairs.
+            if (deltadist != -1)
+            {
+                frontier.push({step.distance + deltadist, found++,
+                               target.id, target.pos,
+                               start ? target.pos : step.first_stair, true});
+            }
         }
-        // deltadist == 0 is legal (if this_stair is nullptr), since the player
-        // may be standing on the stairs. If two stairs are disconnected,
-        // deltadist has to be negative.
-        if (deltadist < 0)
+
+        if (!this_stair && step.level != player_level)
+        {
+            // Whoops, there's no stair in the travel cache for the current
+            // position, and we're not on the player's current level (i.e.,
+            // there certainly *should* be a stair here). Since we can't
+            // proceed in any reasonable way, bail out.
             continue;
+        }
 
-        int dist2stair = distance + deltadist;
-        if (si.distance == -1 || si.distance > dist2stair)
+        for (stair_info &si : li.get_stairs())
         {
-            si.distance = dist2stair;
+            if (stairs_destination_is_excluded(si))
+                continue;
 
-            // Account for the cost of taking the stairs
-            dist2stair += 500; // XXX: this seems large?
+            // Skip placeholders and excluded stairs.
+            if (!si.can_travel() || is_excluded(si.position, li.get_excludes()))
+                continue;
 
-            // Already too expensive? Short-circuit.
-            if (local_distance != -1 && dist2stair >= local_distance)
+            int deltadist = li.distance_between(this_stair, &si);
+
+            if (!this_stair)
+            {
+                deltadist = travel_point_distance[si.position.x][si.position.y];
+                if (!deltadist && you.pos() != si.position)
+                    deltadist = -1;
+            }
+            // deltadist == 0 is legal (if this_stair is nullptr), since the
+            // player may be standing on the stairs. If two stairs are
+            // disconnected, deltadist has to be negative.
+            if (deltadist < 0)
                 continue;
 
+            // Account for the cost of taking the stairs
+            const int dist2stair = step.distance + deltadist
+                                   + 500; // XXX: this seems large?
+            const coord_def first = start ? si.position : step.first_stair;
+
             const level_pos &dest = si.destination;
 
             // Never use escape hatches as the last leg of the trip, since
@@ -3108,12 +3280,8 @@ static int _find_transtravel_stair(const level_id &cur,
             if (target.pos.x == -1
                 && dest.id == target.id)
             {
-                if (local_distance == -1 || local_distance > dist2stair)
-                {
-                    local_distance = dist2stair;
-                    if (cur == player_level && you.pos() == stair)
-                        best_stair = si.position;
-                }
+                frontier.push({dist2stair, found++, dest.id, dest.pos, first,
+                               true});
                 continue;
             }
 
@@ -3142,7 +3310,7 @@ static int _find_transtravel_stair(const level_id &cur,
             // used while exiting from the vestibule.
             if (is_hell_branch(dest.id.branch)
                             && !(is_hell_branch(target.id.branch)
-                                 || is_hell_branch(cur.branch)))
+                                 || is_hell_branch(step.level.branch)))
             {
                 continue;
             }
@@ -3158,28 +3326,17 @@ static int _find_transtravel_stair(const level_id &cur,
                     continue;   // We've already been here.
             }
 #ifdef DEBUG_TRAVEL
-            string indent(search_depth, '.');
-            dprf("%strying stairs at %d,%d, dest is %d depth %d, pos %d,%d",
-                indent.c_str(), si.position.x, si.position.y, dest.id.branch,
+            dprf("trying stairs at %d,%d, dest is %d depth %d, pos %d,%d",
+                si.position.x, si.position.y, dest.id.branch,
                 dest.id.depth, dest.pos.x, dest.pos.y);
 #endif
 
             // Okay, take these stairs and keep going.
-            const int newdist =
-                _find_transtravel_stair(dest.id, target,
-                                        dist2stair, dest.pos, closest_level,
-                                        best_level_distance, best_stair,
-                                        search_depth + 1);
-            if (newdist != -1
-                && (local_distance == -1 || local_distance > newdist))
-            {
-                local_distance = newdist;
-                if (cur == player_level && you.pos() == stair)
-                    best_stair = si.position;
-            }
+            frontier.push({dist2stair, found++, dest.id, dest.pos, first,
+                           false});
         }
     }
-    return local_distance;
+    return -1;
 }
 
 static bool _loadlev_populate_stair_distances(const level_pos &target)
@@ -3248,7 +3405,7 @@ static bool _find_transtravel_square(const level_pos &target, bool verbose)
     if (maybe_traversable)
     {
         _find_transtravel_stair(current, target,
-                                0, cur_stair, closest_level,
+                                cur_stair, closest_level,
                                 best_level_distance, best_stair);
         dprf("found stair at %d,%d", best_stair.x, best_stair.y);
     }
@@ -3631,30 +3788,108 @@ void LevelInfo::set_distance_between_stairs(int a, int b, int dist)
     stair_distances[b * stairs.size() + a] = dist;
 }
 
+// Everything about a square that fill_travel_point_distance() might look at.
+// Must be called with the travel safety grid precomputed.
+static uint32_t _stair_flood_cell(LevelInfo &li, const coord_def &c)
+{
+    uint32_t cell = env.map_knowledge(c).feat()
+                    | is_travelsafe_square(c, false) << 8
+                    | is_travelsafe_square(c, true) << 9
+                    | _is_reseedable(c) << 10
+                    | is_excluded(c) << 11;
+    if (env.grid(c) == DNGN_TRANSPORTER)
+    {
+        const transporter_info *ti = li.get_transporter(c);
+        if (ti && in_bounds(ti->destination))
+        {
+            cell |= (1 + ti->destination.x * GYM + ti->destination.y)
+                    << 12;
+        }
+    }
+    return cell;
+}
+
+// Did any of the squares the last distance flood from this stair looked at
+// change?
+bool LevelInfo::stair_flood_changed(const coord_def &stair,
+                                    const vector<int> &changed) const
+{
+    const auto flood = stair_floods.find(stair);
+    if (flood == stair_floods.end())
+        return true;
+
+    for (int i : changed)
+        if (flood->second[i])
+            return true;
+    return false;
+}
+
 void LevelInfo::update_stair_distances()
 {
     const int nstairs = stairs.size();
-    // Now we update distances for all the stairs, relative to all other
-    // stairs.
-    for (int s = 0; s < nstairs - 1; ++s)
+
+    vector<uint32_t> cells(GXM * GYM, 0);
+    for (rectangle_iterator ri(1); ri; ++ri)
+        cells[ri->x * GYM + ri->y] = _stair_flood_cell(*this, *ri);
+
+    vector<int> changed;
+    const bool all_changed = flood_cells.size() != cells.size();
+    if (!all_changed)
     {
+        for (int i = 0, n = cells.size(); i < n; ++i)
+            if (cells[i] != flood_cells[i])
+                changed.push_back(i);
+    }
+
+    vector<bool> reflood(nstairs);
+    for (int s = 0; s < nstairs; ++s)
+    {
+        reflood[s] = all_changed
+                     || stair_flood_changed(stairs[s].position, changed);
+    }
+
+    map<coord_def, vector<bool>> floods;
+    for (int s = 0; s < nstairs; ++s)
+    {
+        const coord_def pos = stairs[s].position;
         set_distance_between_stairs(s, s, 0);
+        if (!reflood[s])
+        {
+            if (!floods.count(pos))
+                floods[pos] = std::move(stair_floods[pos]);
+            continue;
+        }
 
         // For each stair, we need to ask travel to populate the distance
         // array.
-        fill_travel_point_distance(stairs[s].position);
+        fill_travel_point_distance(pos);
 
         // Assume movement distance between stairs is commutative,
-        // i.e. going from a->b is the same distance as b->a.
-        for (int other = s + 1; other < nstairs; ++other)
+        // i.e. going from a->b is the same distance as b->a. Stairs
+        // refloods after this one will fill in their own distances.
+        for (int other = 0; other < nstairs; ++other)
         {
+            if (other == s || reflood[other] && other < s)
+                continue;
             const coord_def op = stairs[other].position;
             const int dist = travel_point_distance[op.x][op.y];
             set_distance_between_stairs(s, other, dist);
         }
+
+        // The flood looked at every square it reached and their neighbours.
+        vector<bool> &seen = floods[pos];
+        seen.assign(GXM * GYM, false);
+        for (rectangle_iterator ri(1); ri; ++ri)
+        {
+            if (*ri != pos && !travel_point_distance[ri->x][ri->y])
+                continue;
+            for (adjacent_iterator ai(*ri, false); ai; ++ai)
+                seen[ai->x * GYM + ai->y] = true;
+        }
     }
-    if (nstairs)
-        set_distance_between_stairs(nstairs - 1, nstairs - 1, 0);
+
+    flood_cells.swap(cells);
+    stair_floods.swap(floods);
 }
 
 void LevelInfo::update_transporter(const coord_def& transpos,
@@ -3709,6 +3944,10 @@ void LevelInfo::update_stair(const coord_def& stairpos, const level_pos &p,
 void LevelInfo::create_placeholder_stair(const coord_def &stair,
                                          const level_pos &dest)
 {
+    vector<coord_def> old_stairs;
+    for (const stair_info &si : stairs)
+        old_stairs.push_back(si.position);
+
     // If there are any existing placeholders with the same 'dest', zap them.
     erase_if(stairs, [&dest](const stair_info& old_stair)
                      { return old_stair.type == stair_info::PLACEHOLDER
@@ -3721,7 +3960,7 @@ void LevelInfo::create_placeholder_stair(const coord_def &stair,
     placeholder.type        = stair_info::PLACEHOLDER;
     stairs.push_back(placeholder);
 
-    resize_stair_distances();
+    remap_stair_distances(old_stairs);
 }
 
 // If a stair leading out of or into a branch has a known destination, all
@@ -3820,7 +4059,9 @@ int LevelInfo::get_stair_index(const coord_def &pos) const
 
 void LevelInfo::correct_stair_list(const vector<coord_def> &s)
 {
-    stair_distances.clear();
+    vector<coord_def> old_stairs;
+    for (const stair_info &si : stairs)
+        old_stairs.push_back(si.position);
 
     // Fix up the grid for the placeholder stair.
     for (stair_info &stair : stairs)
@@ -3884,7 +4125,7 @@ void LevelInfo::correct_stair_list(const vector<coord_def> &s)
             stairs[found].type = env.map_knowledge(pos).seen() ? stair_info::PHYSICAL : stair_info::MAPPED;
     }
 
-    resize_stair_distances();
+    remap_stair_distances(old_stairs);
 }
 
 void LevelInfo::correct_transporter_list(const vector<coord_def> &t)
@@ -3930,11 +4171,39 @@ void LevelInfo::correct_transporter_list(const vector<coord_def> &t)
     }
 }
 
-void LevelInfo::resize_stair_distances()
+// Reorder stair_distances, which was for stairs at old_stairs, to match the
+// current stair list. Distances to new stairs are unknown (-1) until the
+// next update_stair_distances().
+void LevelInfo::remap_stair_distances(const vector<coord_def> &old_stairs)
 {
+    const int old_n = old_stairs.size();
+    const bool have_old = stair_distances.size() == (size_t) old_n * old_n;
+    if (!have_old)
+        stair_floods.clear();
+
+    vector<int> old_index;
+    for (const stair_info &si : stairs)
+    {
+        const auto found = find(old_stairs.begin(), old_stairs.end(),
+                                si.position);
+        old_index.push_back(have_old && found != old_stairs.end()
+                            ? found - old_stairs.begin() : -1);
+    }
+
     const int nstairs = stairs.size();
-    stair_distances.reserve(nstairs * nstairs);
-    stair_distances.resize(nstairs * nstairs, 0);
+    vector<short> dists(nstairs * nstairs, -1);
+    for (int a = 0; a < nstairs; ++a)
+        for (int b = 0; b < nstairs; ++b)
+        {
+            if (a == b)
+                dists[a * nstairs + b] = 0;
+            else if (old_index[a] != -1 && old_index[b] != -1)
+            {
+                dists[a * nstairs + b] =
+                    stair_distances[old_index[a] * old_n + old_index[b]];
+            }
+        }
+    stair_distances.swap(dists);
 }
 
 int LevelInfo::distance_between(const stair_info *s1, const stair_info *s2)
@@ -4006,18 +4275,16 @@ void LevelInfo::save(writer& outf) const
     for (int i = 0; i < stair_count; ++i)
         stairs[i].save(outf);
 
-    if (stair_count)
-    {
-        // Save stair distances as short ints.
-        const int sz = stair_distances.size();
-        for (int i = 0, n = stair_count * stair_count; i < n; ++i)
+    // Save stair distances as short ints. The distance matrix is symmetric
+    // with a zero diagonal, so only the part above the diagonal is needed.
+    const bool have_dists =
+        stair_distances.size() == (size_t) stair_count * stair_count;
+    for (int a = 0; a < stair_count; ++a)
+        for (int b = a + 1; b < stair_count; ++b)
         {
-            if (i >= sz)
-                marshallShort(outf, -1);
-            else
-                marshallShort(outf, stair_distances[i]);
+            marshallShort(outf, have_dists
+                                ? stair_distances[a * stair_count + b] : -1);
         }
-    }
 
     int transporter_count = transporters.size();
     marshallShort(outf, transporter_count);
@@ -4050,13 +4317,23 @@ void LevelInfo::load(reader& inf, int minorVersion)
         }
     }
 
-    stair_distances.clear();
-    if (stair_count)
+    stair_distances.assign(stair_count * stair_count, 0);
+#if TAG_MAJOR_VERSION == 34
+    if (minorVersion < TAG_MINOR_STAIR_DIST_TRIANGLE)
     {
-        stair_distances.reserve(stair_count * stair_count);
-        for (int i = stair_count * stair_count - 1; i >= 0; --i)
-            stair_distances.push_back(unmarshallShort(inf));
+        for (int i = 0; i < stair_count * stair_count; ++i)
+            stair_distances[i] = unmarshallShort(inf);
     }
+    else
+#endif
+    for (int a = 0; a < stair_count; ++a)
+        for (int b = a + 1; b < stair_count; ++b)
+        {
+            stair_distances[a * stair_count + b] =
+                stair_distances[b * stair_count + a] = unmarshallShort(inf);
+        }
+    flood_cells.clear();
+    stair_floods.clear();
 
     transporters.clear();
 #if TAG_MAJOR_VERSION == 34
@@ -4691,6 +4968,7 @@ void runrest::stop(bool clear_delays)
         (runmode > 0 || runmode < 0 && Options.travel_delay == -1);
     _userdef_run_stoprunning_hook();
     runmode = RMODE_NOT_RUNNING;
+    travel_flood.valid = false;
 
     // Kill the delay; this is fine because it's not possible to stack
     // run/rest/travel on top of other delays.
@@ -394,6 +394,8 @@ private:
     void correct_stair_list(const vector<coord_def> &s);
     void correct_transporter_list(const vector<coord_def> &s);
     void update_stair_distances();
+    bool stair_flood_changed(const coord_def &stair,
+                             const vector<int> &changed) const;
     void sync_all_branch_stairs();
     void sync_branch_stairs(const stair_info *si);
     void set_distance_between_stairs(int a, int b, int dist);
@@ -409,11 +411,17 @@ private:
     vector<short> stair_distances;  // Dist between stairs
     level_id id;
 
+    // Not saved: what the level looked like to travel when stair distances
+    // were last flooded, and for each stair, the squares its flood looked
+    // at. A stair's distances are only reflooded if one of those changed.
+    vector<uint32_t> flood_cells;
+    map<coord_def, vector<bool>> stair_floods;
+
     friend class TravelCache;
 
 private:
     void create_placeholder_stair(const coord_def &, const level_pos &);
-    void resize_stair_distances();
+    void remap_stair_distances(const vector<coord_def> &old_stairs);
 };
 
 const int TRAVEL_WAYPOINT_COUNT = 100;
@@ -0,0 +1,519 @@
+/**
+ * @file
+ * @brief Generate the ray tables used by los.cc.
+ *
+ * This is a host tool: it is built from this file, ray.cc and geom2d.cc,
+ * and writes los-tables.h to standard output. The tables only depend on
+ * LOS_MAX_RANGE and the ray geometry, so los-tables.h is kept in the
+ * repository; rebuild it with "make los-tables" after changing either.
+ *
+ * See the comment at the top of los.cc for the terminology.
+**/
+
+#include "AppHdr.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+
+#include "los.h"
+#include "ray.h"
+
+// These determine what rays are cast in the precomputation.
+// XXX: Argue that these values are sufficient.
+#define LOS_MAX_ANGLE (2*LOS_MAX_RANGE-2)
+#define LOS_INTERCEPT_MULT (2)
+
+// Width of the blockray masks: masks are made of 64-bit words, and
+// padded to a whole cache line.
+#define LOS_MASK_WORD_BITS 64
+#define LOS_MASK_ALIGN_WORDS 8
+
+#define QUADRANT_SIZE (LOS_MAX_RANGE+1)
+
+// These store all unique (in terms of footprint) full rays.
+// The footprint of ray=fullray[i] consists of ray.length cells,
+// stored in ray_coords[ray.start..ray.length-1].
+struct los_ray;
+static vector<los_ray> fullrays;
+static vector<coord_def> ray_coords;
+
+static void _fail(const char *msg)
+{
+    fprintf(stderr, "gen-los-tables: %s\n", msg);
+    exit(1);
+}
+
+struct los_ray : public ray_def
+{
+    // The footprint of this ray is stored in
+    // ray_coords[start..start+length-1].
+    unsigned int start;
+    unsigned int length;
+    // Index into fullrays.
+    unsigned int id;
+
+    los_ray(geom::ray _r)
+        : ray_def(_r), start(0), length(0), id(0)
+    {
+    }
+
+    // Shoot a ray from the given start point (accx, accy) with the given
+    // slope, bounded by the pre-calc bounds shape.
+    // Returns the cells it travels through, excluding the origin.
+    // Returns an empty vector if this was a bad ray.
+    vector<coord_def> footprint()
+    {
+        vector<coord_def> cs;
+        los_ray copy = *this;
+        coord_def c;
+        for (;;)
+        {
+            if (!copy.advance())
+            {
+                cs.clear();
+                break;
+            }
+            c = copy.pos();
+            if (c.rdist() > LOS_RADIUS)
+                break;
+            cs.push_back(c);
+        }
+        return cs;
+    }
+
+    coord_def operator[](unsigned int i) const
+    {
+        return ray_coords[start+i];
+    }
+};
+
+// Check if the passed rays have identical footprint.
+static bool _is_same_ray(const los_ray &ray, const vector<coord_def> &newray)
+{
+    if (ray.length != newray.size())
+        return false;
+    for (unsigned int i = 0; i < ray.length; i++)
+        if (ray[i] != newray[i])
+            return false;
+    return true;
+}
+
+// Check if the passed ray has already been created.
+static bool _is_duplicate_ray(const vector<coord_def> &newray)
+{
+    for (const los_ray &lray : fullrays)
+        if (_is_same_ray(lray, newray))
+            return true;
+    return false;
+}
+
+// A cellray given by fullray and index of end-point.
+struct cellray
+{
+    // A cellray passes through cells ray_coords[ray.start..ray.start+end].
+    los_ray ray;
+    unsigned int end; // Relative index (inside ray) of end cell.
+
+    cellray(const los_ray& r, unsigned int e)
+        : ray(r), end(e), imbalance(-1), first_diag(false)
+    {
+    }
+
+    // The end-point's index inside ray_coord.
+    int index() const { return ray.start + end; }
+
+    // The end-point.
+    coord_def target() const { return ray_coords[index()]; }
+
+    coord_def operator[](unsigned int i) const
+    {
+        return ray_coords[ray.start+i];
+    }
+
+    // Parameters used in find_ray. These need to be calculated
+    // only for the minimal cellrays.
+    int imbalance;
+    bool first_diag;
+
+    void calc_params();
+};
+
+static int _imbalance(ray_def ray, const coord_def& target)
+{
+    int imb = 0;
+    int diags = 0, straights = 0;
+    while (ray.pos() != target)
+    {
+        coord_def old = ray.pos();
+        if (!ray.advance())
+            _fail("can't advance ray");
+        switch ((ray.pos() - old).abs())
+        {
+        case 1:
+            diags = 0;
+            if (++straights > imb)
+                imb = straights;
+            break;
+        case 2:
+            straights = 0;
+            if (++diags > imb)
+                imb = diags;
+            break;
+        default:
+            _fail("ray imbalance out of range");
+        }
+    }
+    return imb;
+}
+
+void cellray::calc_params()
+{
+    coord_def trg = target();
+    imbalance = _imbalance(ray, trg);
+    first_diag = ((*this)[0].abs() == 2);
+}
+
+// Compare two cellrays to the same target.
+// This determines which ray is considered better by find_ray,
+// used with list::sort.
+// Returns true if a is strictly better than b, false else.
+static bool _is_better(const cellray& a, const cellray& b)
+{
+    if (a.imbalance < b.imbalance)
+        return true;
+    else if (a.imbalance > b.imbalance)
+        return false;
+    else
+        return a.first_diag && !b.first_diag;
+}
+
+enum class compare_type
+{
+    neither,
+    subray,
+    superray,
+};
+
+// Check whether one of the passed cellrays is a subray of the
+// other in terms of footprint.
+static compare_type _compare_cellrays(const cellray& a, const cellray& b)
+{
+    if (a.target() != b.target())
+        return compare_type::neither;
+
+    int cura = a.ray.start;
+    int curb = b.ray.start;
+    int enda = cura + a.end;
+    int endb = curb + b.end;
+    bool maybe_sub = true;
+    bool maybe_super = true;
+
+    while (cura < enda && curb < endb && (maybe_sub || maybe_super))
+    {
+        coord_def pa = ray_coords[cura];
+        coord_def pb = ray_coords[curb];
+        if (pa.x > pb.x || pa.y > pb.y)
+        {
+            maybe_super = false;
+            curb++;
+        }
+        if (pa.x < pb.x || pa.y < pb.y)
+        {
+            maybe_sub = false;
+            cura++;
+        }
+        if (pa == pb)
+        {
+            cura++;
+            curb++;
+        }
+    }
+    maybe_sub = maybe_sub && cura == enda;
+    maybe_super = maybe_super && curb == endb;
+
+    if (maybe_sub)
+        return compare_type::subray;    // includes equality
+    else if (maybe_super)
+        return compare_type::superray;
+    else
+        return compare_type::neither;
+}
+
+// Determine all minimal cellrays, in the order in which they're
+// numbered for the blockray masks, and fill in min_cellrays with
+// the minimal cellrays by target, best first.
+static vector<cellray> _find_minimal_cellrays(
+    FixedArray<vector<cellray>, QUADRANT_SIZE, QUADRANT_SIZE> &min_cellrays)
+{
+    FixedArray<list<cellray>, QUADRANT_SIZE, QUADRANT_SIZE> minima;
+    list<cellray>::iterator min_it;
+
+    for (const los_ray &ray : fullrays)
+    {
+        for (unsigned int i = 0; i < ray.length; ++i)
+        {
+            // Is the cellray ray[0..i] duplicated so far?
+            bool dup = false;
+            cellray c(ray, i);
+            list<cellray>& min = minima(c.target());
+
+            bool erased = false;
+            for (min_it = min.begin();
+                 min_it != min.end() && !dup;)
+            {
+                switch (_compare_cellrays(*min_it, c))
+                {
+                case compare_type::subray:
+                    dup = true;
+                    break;
+                case compare_type::superray:
+                    min_it = min.erase(min_it);
+                    erased = true;
+                    // clear this should be added, but might have
+                    // to erase more
+                    break;
+                case compare_type::neither:
+                default:
+                    break;
+                }
+                if (!erased)
+                    ++min_it;
+                else
+                    erased = false;
+            }
+            if (!dup)
+                min.push_back(c);
+        }
+    }
+
+    vector<cellray> result;
+    for (int y = 0; y < QUADRANT_SIZE; ++y)
+        for (int x = 0; x < QUADRANT_SIZE; ++x)
+        {
+            list<cellray>& min = minima[x][y];
+            for (min_it = min.begin(); min_it != min.end(); ++min_it)
+            {
+                // Calculate imbalance and slope difference for sorting.
+                min_it->calc_params();
+                result.push_back(*min_it);
+            }
+            min.sort(_is_better);
+            min_cellrays[x][y] = vector<cellray>(min.begin(), min.end());
+        }
+    return result;
+}
+
+// Create and register the ray defined by the arguments.
+static void _register_ray(geom::ray r)
+{
+    los_ray ray = los_ray(r);
+    vector<coord_def> coords = ray.footprint();
+
+    if (coords.empty() || _is_duplicate_ray(coords))
+        return;
+
+    ray.start = ray_coords.size();
+    ray.length = coords.size();
+    ray.id = fullrays.size();
+    for (coord_def c : coords)
+        ray_coords.push_back(c);
+    fullrays.push_back(ray);
+}
+
+static int _gcd(int x, int y)
+{
+    int tmp;
+    while (y != 0)
+    {
+        x %= y;
+        tmp = x;
+        x = y;
+        y = tmp;
+    }
+    return x;
+}
+
+static bool _complexity_lt(const pair<int,int>& lhs, const pair<int,int>& rhs)
+{
+    return lhs.first * lhs.second < rhs.first * rhs.second;
+}
+
+// Cast all rays in the first quadrant.
+static void _raycast()
+{
+    // register perpendiculars FIRST, to make them top choice
+    // when selecting beams
+    _register_ray(geom::ray(0.5, 0.5, 0.0, 1.0));
+    _register_ray(geom::ray(0.5, 0.5, 1.0, 0.0));
+
+    // For a slope of M = y/x, every x we move on the X axis means
+    // that we move y on the y axis. We want to look at the resolution
+    // of x/y: in that case, every step on the X axis means an increase
+    // of 1 in the Y axis at the intercept point. We can assume gcd(x,y)=1,
+    // so we look at steps of 1/y.
+
+    // Changing the order a bit. We want to order by the complexity
+    // of the beam, which is log(x) + log(y) ~ xy.
+    vector<pair<int,int> > xyangles;
+    for (int xangle = 1; xangle <= LOS_MAX_ANGLE; ++xangle)
+        for (int yangle = 1; yangle <= LOS_MAX_ANGLE; ++yangle)
+        {
+            if (_gcd(xangle, yangle) == 1)
+                xyangles.emplace_back(xangle, yangle);
+        }
+
+    sort(xyangles.begin(), xyangles.end(), _complexity_lt);
+    for (auto xyangle : xyangles)
+    {
+        const int xangle = xyangle.first;
+        const int yangle = xyangle.second;
+
+        for (int intercept = 1; intercept < LOS_INTERCEPT_MULT*yangle; ++intercept)
+        {
+            double xstart = ((double)intercept) / (LOS_INTERCEPT_MULT*yangle);
+            double ystart = 0.5;
+
+            _register_ray(geom::ray(xstart, ystart, xangle, yangle));
+            // also draw the identical ray in octant 2
+            _register_ray(geom::ray(ystart, xstart, yangle, xangle));
+        }
+    }
+}
+
+static void _print_coord(const coord_def &c, int n)
+{
+    printf("%s{%d,%d},", n % 10 ? "" : "\n    ", c.x, c.y);
+}
+
+int main()
+{
+    _raycast();
+
+    FixedArray<vector<cellray>, QUADRANT_SIZE, QUADRANT_SIZE> min_cellrays;
+    const vector<cellray> cellrays = _find_minimal_cellrays(min_cellrays);
+    const unsigned int n_min_rays = cellrays.size();
+
+    const unsigned int words = (n_min_rays + LOS_MASK_WORD_BITS - 1)
+                               / LOS_MASK_WORD_BITS;
+    const unsigned int mask_words = (words + LOS_MASK_ALIGN_WORDS - 1)
+                                    / LOS_MASK_ALIGN_WORDS
+                                    * LOS_MASK_ALIGN_WORDS;
+
+    // Blocking information for the minimal cellrays: every cell of a
+    // cellray other than its end blocks it.
+    FixedArray<vector<uint64_t>, QUADRANT_SIZE, QUADRANT_SIZE> blockrays;
+    for (int y = 0; y < QUADRANT_SIZE; ++y)
+        for (int x = 0; x < QUADRANT_SIZE; ++x)
+            blockrays[x][y].assign(mask_words, 0);
+    for (unsigned int i = 0; i < n_min_rays; ++i)
+        for (unsigned int j = 0; j < cellrays[i].end; ++j)
+        {
+            blockrays(cellrays[i][j])[i / LOS_MASK_WORD_BITS]
+                |= uint64_t(1) << (i % LOS_MASK_WORD_BITS);
+        }
+
+    printf("// Generated by util/gen-los-tables.cc; do not edit.\n"
+           "// Regenerate with \"make los-tables\" after changing"
+           " LOS_MAX_RANGE\n"
+           "// or the ray geometry in ray.cc and geom2d.cc.\n"
+           "//\n"
+           "// Cellrays: %u Fullrays: %u Minimal cellrays: %u\n\n",
+           (unsigned int)ray_coords.size(), (unsigned int)fullrays.size(),
+           n_min_rays);
+    printf("#pragma once\n\n"
+           "#if LOS_MAX_RANGE != %d\n"
+           "# error \"los-tables.h is out of date; run 'make los-tables'\"\n"
+           "#endif\n\n", LOS_MAX_RANGE);
+    printf("// A fullray: its starting point and direction, and where its\n"
+           "// footprint is stored in los_ray_coords.\n"
+           "struct los_table_ray\n"
+           "{\n"
+           "    double start_x, start_y, dir_x, dir_y;\n"
+           "    unsigned short start;\n"
+           "    unsigned short length;\n"
+           "};\n\n"
+           "// A minimal cellray, given by its fullray and the relative index\n"
+           "// of its end cell inside that ray.\n"
+           "struct los_table_cellray\n"
+           "{\n"
+           "    unsigned short ray;\n"
+           "    unsigned short end;\n"
+           "};\n\n"
+           "typedef uint64_t los_mask_word;\n"
+           "#define LOS_MASK_WORD_BITS %d\n"
+           "#define LOS_MASK_ALIGN %d\n\n",
+           LOS_MASK_WORD_BITS,
+           LOS_MASK_ALIGN_WORDS * LOS_MASK_WORD_BITS / 8);
+    printf("#define LOS_NUM_FULLRAYS %u\n", (unsigned int)fullrays.size());
+    printf("#define LOS_NUM_RAY_COORDS %u\n", (unsigned int)ray_coords.size());
+    printf("#define LOS_NUM_CELLRAYS %u\n", n_min_rays);
+    printf("#define LOS_MASK_WORDS %u\n\n", mask_words);
+
+    printf("static const los_table_ray los_fullrays[LOS_NUM_FULLRAYS] =\n{");
+    for (const los_ray &ray : fullrays)
+    {
+        printf("\n    { %.17g, %.17g, %.17g, %.17g, %u, %u },",
+               ray.r.start.x, ray.r.start.y, ray.r.dir.x, ray.r.dir.y,
+               ray.start, ray.length);
+    }
+    printf("\n};\n\n");
+
+    printf("static const coord_def los_ray_coords[LOS_NUM_RAY_COORDS] =\n{");
+    for (unsigned int i = 0; i < ray_coords.size(); ++i)
+        _print_coord(ray_coords[i], i);
+    printf("\n};\n\n");
+
+    printf("static const coord_def los_cellray_ends[LOS_NUM_CELLRAYS] =\n{");
+    for (unsigned int i = 0; i < n_min_rays; ++i)
+        _print_coord(cellrays[i].target(), i);
+    printf("\n};\n\n");
+
+    // The minimal cellrays grouped by target, best first; the ones
+    // ending at (x, y) are los_min_cellrays[first[i]..first[i+1]-1]
+    // with i = y * (LOS_MAX_RANGE+1) + x.
+    vector<unsigned int> first;
+    printf("static const los_table_cellray "
+           "los_min_cellrays[LOS_NUM_CELLRAYS] =\n{");
+    unsigned int n = 0;
+    for (int y = 0; y < QUADRANT_SIZE; ++y)
+        for (int x = 0; x < QUADRANT_SIZE; ++x)
+        {
+            first.push_back(n);
+            for (const cellray &c : min_cellrays[x][y])
+            {
+                printf("%s{%u,%u},", n % 8 ? "" : "\n    ",
+                       c.ray.id, c.end);
+                ++n;
+            }
+        }
+    first.push_back(n);
+    if (n != n_min_rays)
+        _fail("minimal cellray count mismatch");
+    printf("\n};\n\n");
+
+    printf("static const unsigned short los_min_cellrays_first"
+           "[(LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1) + 1] =\n{");
+    for (unsigned int i = 0; i < first.size(); ++i)
+        printf("%s%u,", i % 10 ? " " : "\n    ", first[i]);
+    printf("\n};\n\n");
+
+    printf("alignas(LOS_MASK_ALIGN) static const los_mask_word\n"
+           "los_blockray_masks[(LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1)]"
+           "[LOS_MASK_WORDS] =\n{");
+    for (int y = 0; y < QUADRANT_SIZE; ++y)
+        for (int x = 0; x < QUADRANT_SIZE; ++x)
+        {
+            printf("\n    { // (%d,%d)", x, y);
+            for (unsigned int w = 0; w < mask_words; ++w)
+            {
+                printf("%s0x%016llxULL,", w % 4 ? " " : "\n        ",
+                       (unsigned long long)blockrays[x][y][w]);
+            }
+            printf("\n    },");
+        }
+    printf("\n};\n");
+
+    return 0;
+}
@@ -170,9 +170,8 @@ static void _apply_randart_properties(item_def &item,
                                       const string &name,
                                       const string &props)
 {
-    CrawlVector &rap = item.props[ARTEFACT_PROPS_KEY].get_vector();
-    for (vec_size i = 0; i < ART_PROPERTIES; i++)
-        rap[i] = static_cast<short>(0);
+    artefact_prop_block &rap = item.art_props;
+    rap.init();
 
     set_artefact_name(item, name);
 
@@ -205,7 +204,7 @@ static void _apply_randart_properties(item_def &item,
             for (short j = 1; j < 9; j++)
             {
                 item_def copy = item;
-                copy.props[ARTEFACT_PROPS_KEY].get_vector()[i] = j;
+                copy.art_props[i] = j;
                 string ins_with_prop = ins.length()
                     ? ins + " " + brand_name
                     : brand_name;
@@ -218,7 +217,7 @@ static void _apply_randart_properties(item_def &item,
             for (short j = -1; j > -8; j--)
             {
                 item_def copy = item;
-                copy.props[ARTEFACT_PROPS_KEY].get_vector()[i] = j;
+                copy.art_props[i] = j;
                 string ins_with_prop = ins.length()
                     ? ins + " " + brand_name
                     : brand_name;
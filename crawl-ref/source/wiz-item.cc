@@ -465,7 +465,7 @@ void wizard_tweak_object()
 
         if (keyin == 'e' && new_val & ISFLAG_ARTEFACT_MASK
             && (!you.inv[item].props.exists(KNOWN_PROPS_KEY)
-             || !you.inv[item].props.exists(ARTEFACT_PROPS_KEY)))
+             || !you.inv[item].art_props))
         {
             mpr("You can't set this flag on a non-artefact.");
             continue;
@@ -486,7 +486,11 @@ void wizard_tweak_object()
         else if (keyin == 'd')
             you.inv[item].quantity = new_val;
         else if (keyin == 'e')
+        {
+            // This can make a worn item stop or start being an artefact.
             you.inv[item].flags = new_val;
+            you.invalidate_artefact_totals();
+        }
         else
             die("unhandled keyin");
 
@@ -664,6 +668,7 @@ void wizard_make_object_randart()
         item.unrand_idx = 0;
         item.flags  &= ~ISFLAG_RANDART;
         item.props.clear();
+        item.art_props.reset();
     }
 
     mprf(MSGCH_PROMPT, "Fake item as gift from which god (ENTER to leave alone): ");
@@ -1333,6 +1338,7 @@ static void _debug_rap_stats(FILE *ostat)
     item.flags  &= ~ISFLAG_ARTEFACT_MASK;
     item.unrand_idx = 0;
     item.props.clear();
+    item.art_props.reset();
 
     if (!make_item_randart(item))
     {
@@ -1375,6 +1381,7 @@ static void _debug_rap_stats(FILE *ostat)
         item.flags  &= ~ISFLAG_ARTEFACT_MASK;
         item.unrand_idx = 0;
         item.props.clear();
+        item.art_props.reset();
         make_item_randart(item);
         artefact_properties(item, proprt);
 